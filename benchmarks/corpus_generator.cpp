@@ -0,0 +1,51 @@
+// Generates the benchmark corpus of io::Reader.
+//
+// Usage: corpus_generator <output_dir> <size> [seed] [corpus...]
+//
+// Writes <output_dir>/<corpus>.in for each corpus (all of them by default),
+// each of about <size> bytes; the size can have a K, M or G suffix. The same
+// seed (0 by default) always produces the same files.
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../src/benchmark_corpus.hpp"
+
+using namespace cplib;
+
+std::size_t parse_size(std::string const& s) {
+    std::size_t pos;
+    std::size_t size = std::stoull(s, &pos);
+    std::string suffix = s.substr(pos);
+    if (suffix == "K") return size << 10;
+    if (suffix == "M") return size << 20;
+    if (suffix == "G") return size << 30;
+    if (suffix.empty()) return size;
+    throw InvalidArgumentException("Invalid size " + s);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <output_dir> <size> [seed] [corpus...]" << std::endl;
+        return 2;
+    }
+    std::string output_dir = argv[1];
+    std::size_t size = parse_size(argv[2]);
+    std::uint64_t seed = argc > 3 ? std::stoull(argv[3]) : 0;
+    std::vector<bench::Corpus> corpora;
+    for (int i = 4; i < argc; ++i) {
+        corpora.push_back(bench::corpus_from_name(argv[i]));
+    }
+    if (corpora.empty()) corpora = bench::all_corpora();
+
+    for (bench::Corpus corpus : corpora) {
+        std::string file_name =
+            output_dir + "/" + bench::corpus_name(corpus) + ".in";
+        io::Writer w(file_name.c_str());
+        bench::write_corpus(w, corpus, size, seed);
+        std::cerr << "Wrote " << file_name << std::endl;
+    }
+}
@@ -0,0 +1,381 @@
+// Compares io::Reader with a testlib-style reader and with scanf on the
+// validators of the examples, at their maximum constraints.
+//
+// Usage: reader_comparison [output_dir] [repetitions]
+//
+// Writes the inputs into <output_dir> (/tmp by default), then runs each
+// validator with each reader in its own process (see timing::Runner), and
+// prints their median CPU time, throughput and peak memory. The cplib and
+// testlib-style validators check the exact layout of the input; the scanf ones
+// only check the values, as a lower bound of the cost of reading.
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../src/generator.hpp"
+#include "../src/io.hpp"
+#include "../src/string_generator.hpp"
+#include "../src/timing.hpp"
+#include "../src/validation.hpp"
+
+using namespace cplib;
+
+// A minimal reader in the style of testlib's InStream: characters are read one
+// at a time from a FILE*, and every token is checked strictly.
+class InStream {
+   private:
+    FILE* file;
+
+    [[noreturn]] void quit(std::string const& msg) {
+        throw FailedValidationException(msg);
+    }
+
+   public:
+    explicit InStream(const char* file_name) : file(fopen(file_name, "r")) {
+        if (file == nullptr) throw io::OpenFailureException(file_name);
+    }
+    ~InStream() { fclose(file); }
+
+    long long readLong(long long min_value, long long max_value) {
+        int c = getc_unlocked(file);
+        bool negative = c == '-';
+        if (negative) c = getc_unlocked(file);
+        if (c < '0' || c > '9') quit("Expected an integer");
+        if (c == '0' && negative) quit("Expected an integer");
+        unsigned long long x = 0;
+        int digits = 0;
+        for (; c >= '0' && c <= '9'; c = getc_unlocked(file), ++digits) {
+            if (digits > 0 && x == 0) quit("Leading zeros");
+            if (digits >= 19) quit("Integer overflow");
+            x = x * 10 + (c - '0');
+        }
+        ungetc(c, file);
+        long long value = negative ? -static_cast<long long>(x) : x;
+        if (value < min_value || value > max_value) quit("Out of range");
+        return value;
+    }
+    int readInt(int min_value, int max_value) {
+        return readLong(min_value, max_value);
+    }
+
+    std::string readWord(std::string const& allowed, std::size_t length) {
+        std::string s;
+        s.reserve(length);
+        int c;
+        while ((c = getc_unlocked(file)) != EOF && c != ' ' && c != '\n') {
+            if (allowed.find(c) == std::string::npos) quit("Invalid char");
+            s += static_cast<char>(c);
+        }
+        ungetc(c, file);
+        if (s.size() != length) quit("Wrong length");
+        return s;
+    }
+
+    void readSpace() {
+        if (getc_unlocked(file) != ' ') quit("Expected space");
+    }
+    void readEoln() {
+        if (getc_unlocked(file) != '\n') quit("Expected newline");
+    }
+    void readEof() {
+        if (getc_unlocked(file) != EOF) quit("Expected EOF");
+    }
+};
+
+void check(bool condition, const char* msg) {
+    if (!condition) throw FailedValidationException(msg);
+}
+
+FILE* open(const char* file_name) {
+    FILE* f = fopen(file_name, "r");
+    if (f == nullptr) throw io::OpenFailureException(file_name);
+    return f;
+}
+
+// The validators, with the same checks as in the examples.
+namespace bus {
+
+constexpr int MAXN = 100'000, MAXL = 100'000, MAX_SUMK = 300'000;
+
+void generate(io::Writer& w) {
+    gen::Random rng(0);
+    w.write_string(std::to_string(MAXN) + " " + std::to_string(MAXL) + "\n");
+    for (int i = 0; i < MAXL; ++i) {
+        int k = MAX_SUMK / MAXL;
+        w.write_integer(k);
+        for (int j = 0, last = -1; j < k; ++j) {
+            int x;
+            do {
+                x = rng.next(0, MAXN - 1);
+            } while (x == last);
+            last = x;
+            w.write_space();
+            w.write_integer(x);
+        }
+        w.write_newline();
+    }
+}
+
+void validate_cplib(const char* file) {
+    auto r = io::Reader(file, true);
+    int N = r.read<int>();
+    ASSERT(val::between(N, 2, MAXN));
+    r.must_be_space();
+    int L = r.read<int>();
+    ASSERT(val::between(L, 1, MAXL));
+    r.must_be_newline();
+    int sumK = 0;
+    for (int i = 0; i < L; ++i) {
+        int K = r.read_integer<int>(2, Limits<int>::MAX);
+        sumK += K;
+        r.must_be_space();
+        auto F = r.read<int>(K);
+        ASSERT(val::all_between(F, 0, N - 1));
+        int cur = F[0];
+        ASSERT(val::all(std::next(F.begin()), F.end(), [&cur](int x) {
+            auto res = val::neq(cur, x);
+            cur = x;
+            return res;
+        }))
+        r.must_be_newline();
+    }
+    ASSERT(val::lte(sumK, MAX_SUMK));
+    r.must_be_eof();
+}
+
+void validate_testlib(const char* file) {
+    InStream in(file);
+    int N = in.readInt(2, MAXN);
+    in.readSpace();
+    int L = in.readInt(1, MAXL);
+    in.readEoln();
+    int sumK = 0;
+    for (int i = 0; i < L; ++i) {
+        int K = in.readInt(2, Limits<int>::MAX);
+        sumK += K;
+        for (int j = 0, last = -1; j < K; ++j) {
+            in.readSpace();
+            int x = in.readInt(0, N - 1);
+            check(x != last, "Equal neighbors");
+            last = x;
+        }
+        in.readEoln();
+    }
+    check(sumK <= MAX_SUMK, "Sum of K too large");
+    in.readEof();
+}
+
+void validate_scanf(const char* file) {
+    FILE* f = open(file);
+    int N, L, sumK = 0;
+    check(fscanf(f, "%d %d", &N, &L) == 2, "Expected N, L");
+    check(2 <= N && N <= MAXN && 1 <= L && L <= MAXL, "Out of range");
+    for (int i = 0; i < L; ++i) {
+        int K;
+        check(fscanf(f, "%d", &K) == 1 && K >= 2, "Expected K");
+        sumK += K;
+        for (int j = 0, last = -1; j < K; ++j) {
+            int x;
+            check(fscanf(f, "%d", &x) == 1, "Expected F");
+            check(0 <= x && x < N && x != last, "Invalid F");
+            last = x;
+        }
+    }
+    check(sumK <= MAX_SUMK, "Sum of K too large");
+    fclose(f);
+}
+
+}  // namespace bus
+
+namespace bastioni {
+
+constexpr int MAXN = 300'000;
+
+void generate(io::Writer& w) {
+    gen::Random rng(0);
+    w.write_integer(MAXN);
+    w.write_newline();
+    gen::write_random_string(w, rng, MAXN, "=#<>");
+    w.write_newline();
+}
+
+void validate_cplib(const char* file) {
+    auto r = io::Reader(file, true);
+    int N = r.read_integer<int>(1, MAXN);
+    r.must_be_newline();
+    std::string S = r.read_string("=#<>", N);
+    r.must_be_newline();
+    r.must_be_eof();
+}
+
+void validate_testlib(const char* file) {
+    InStream in(file);
+    int N = in.readInt(1, MAXN);
+    in.readEoln();
+    std::string S = in.readWord("=#<>", N);
+    in.readEoln();
+    in.readEof();
+}
+
+void validate_scanf(const char* file) {
+    FILE* f = open(file);
+    int N;
+    check(fscanf(f, "%d", &N) == 1 && 1 <= N && N <= MAXN, "Expected N");
+    // Up to N + 1 characters, so that a longer string has the wrong length.
+    std::vector<char> S(N + 2);
+    std::string format = "%" + std::to_string(N + 1) + "s";
+    check(fscanf(f, format.c_str(), S.data()) == 1, "Expected S");
+    check(std::strlen(S.data()) == static_cast<std::size_t>(N),
+          "Wrong length");
+    for (int i = 0; i < N; ++i) {
+        check(std::strchr("=#<>", S[i]) != nullptr, "Invalid char");
+    }
+    fclose(f);
+}
+
+}  // namespace bastioni
+
+namespace islands {
+
+constexpr int MAXRC = 1000;
+
+void generate(io::Writer& w) {
+    gen::Random rng(0);
+    w.write_string(std::to_string(MAXRC) + " " + std::to_string(MAXRC) + "\n");
+    for (int i = 0; i < MAXRC; ++i) {
+        for (int j = 0; j < MAXRC; ++j) {
+            if (j > 0) w.write_space();
+            w.write_integer(rng.next(0, 1));
+        }
+        w.write_newline();
+    }
+}
+
+void validate_cplib(const char* file) {
+    auto r = io::Reader(file, true);
+    int R = r.read_integer<int>(1, MAXRC);
+    r.must_be_space();
+    int C = r.read_integer<int>(1, MAXRC);
+    r.must_be_newline();
+    auto M = r.read<short>(R, C);
+    ASSERT(val::all(M, [](auto const& v) { return val::all_between(v, 0, 1); }))
+    r.must_be_newline();
+    r.must_be_eof();
+}
+
+void validate_testlib(const char* file) {
+    InStream in(file);
+    int R = in.readInt(1, MAXRC);
+    in.readSpace();
+    int C = in.readInt(1, MAXRC);
+    in.readEoln();
+    for (int i = 0; i < R; ++i) {
+        for (int j = 0; j < C; ++j) {
+            if (j > 0) in.readSpace();
+            in.readInt(0, 1);
+        }
+        in.readEoln();
+    }
+    in.readEof();
+}
+
+void validate_scanf(const char* file) {
+    FILE* f = open(file);
+    int R, C;
+    check(fscanf(f, "%d %d", &R, &C) == 2, "Expected R, C");
+    check(1 <= R && R <= MAXRC && 1 <= C && C <= MAXRC, "Out of range");
+    for (int i = 0; i < R * C; ++i) {
+        int x;
+        check(fscanf(f, "%d", &x) == 1 && (x == 0 || x == 1), "Invalid cell");
+    }
+    fclose(f);
+}
+
+}  // namespace islands
+
+struct Task {
+    std::string name;
+    std::function<void(io::Writer&)> generate;
+    std::map<std::string, std::function<void(const char*)>> validators;
+};
+
+const std::vector<Task> TASKS = {
+    {"oii2022_bus",
+     bus::generate,
+     {{"cplib", bus::validate_cplib},
+      {"testlib", bus::validate_testlib},
+      {"scanf", bus::validate_scanf}}},
+    {"oii2023_bastioni",
+     bastioni::generate,
+     {{"cplib", bastioni::validate_cplib},
+      {"testlib", bastioni::validate_testlib},
+      {"scanf", bastioni::validate_scanf}}},
+    {"ois2020_islands",
+     islands::generate,
+     {{"cplib", islands::validate_cplib},
+      {"testlib", islands::validate_testlib},
+      {"scanf", islands::validate_scanf}}},
+};
+
+const std::vector<std::string> READERS = {"cplib", "testlib", "scanf"};
+
+// Runs a single validator on standard input: this is what is timed.
+int validate(std::string const& task, std::string const& reader) {
+    for (Task const& t : TASKS) {
+        if (t.name != task) continue;
+        try {
+            t.validators.at(reader)("/dev/stdin");
+            return 0;
+        } catch (std::exception const& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 4 && std::string(argv[1]) == "--validate") {
+        return validate(argv[2], argv[3]);
+    }
+    std::string output_dir = argc > 1 ? argv[1] : "/tmp";
+    std::size_t repetitions = argc > 2 ? std::stoul(argv[2]) : 5;
+
+    io::Writer out("/dev/stdout");
+    out.write_string("task reader cpu_median_ms wall_median_ms mb_per_s "
+                     "peak_mib status\n");
+    for (Task const& task : TASKS) {
+        std::string file_name = output_dir + "/" + task.name + ".in";
+        {
+            io::Writer w(file_name.c_str());
+            task.generate(w);
+        }
+        std::ifstream in(file_name, std::ios::binary | std::ios::ate);
+        double megabytes = in.tellg() / 1e6;
+        for (std::string const& reader : READERS) {
+            timing::Report report =
+                timing::Runner({"/proc/self/exe", "--validate", task.name,
+                                reader})
+                    .with_repetitions(repetitions)
+                    .run({file_name});
+            timing::TestReport const& t = report.tests[0];
+            out.write_string(task.name + " " + reader + " ");
+            out.write_floating_point(t.cpu_time.median * 1e3, 1);
+            out.write_space();
+            out.write_floating_point(t.wall_time.median * 1e3, 1);
+            out.write_space();
+            out.write_floating_point(megabytes / t.cpu_time.median, 1);
+            out.write_space();
+            out.write_floating_point(t.peak_memory / 1048576.0, 1);
+            out.write_space();
+            out.write_string(t.error.empty() ? std::string("OK") : "FAILED");
+            out.write_newline();
+        }
+    }
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+#include "generator.hpp"
+#include "io.hpp"
+#include "string_generator.hpp"
+
+namespace cplib::bench {
+
+// Canonical inputs for benchmarking io::Reader. Each of them starts with a
+// header line giving its shape, so that it can be read back.
+enum class Corpus {
+    // n, then n integers in [0, 99] on a line.
+    SMALL_INTEGERS,
+    // n, then n integers spanning the whole range of int64 (mostly 19 digits)
+    // on a line.
+    INT64,
+    // n, then n integers in [-10^9, -1] on a line.
+    NEGATIVE_INTEGERS,
+    // n, then n reals in (-10^6, 10^6) with 9 decimals on a line.
+    FLOATS,
+    // k and l, then k lines with a string of l lowercase letters.
+    LONG_STRINGS,
+    // r and c, then r lines with c characters in ".#".
+    GRID,
+    // n, then n integers in [-10^9, 10^9], with runs of up to four spaces,
+    // tabs and newlines around every token (for non-strict mode).
+    WHITESPACE,
+};
+
+inline std::vector<Corpus> const& all_corpora() {
+    static const std::vector<Corpus> corpora = {
+        Corpus::SMALL_INTEGERS, Corpus::INT64,        Corpus::NEGATIVE_INTEGERS,
+        Corpus::FLOATS,         Corpus::LONG_STRINGS, Corpus::GRID,
+        Corpus::WHITESPACE};
+    return corpora;
+}
+
+inline std::string corpus_name(Corpus corpus) {
+    switch (corpus) {
+        case Corpus::SMALL_INTEGERS:
+            return "small_integers";
+        case Corpus::INT64:
+            return "int64";
+        case Corpus::NEGATIVE_INTEGERS:
+            return "negative_integers";
+        case Corpus::FLOATS:
+            return "floats";
+        case Corpus::LONG_STRINGS:
+            return "long_strings";
+        case Corpus::GRID:
+            return "grid";
+        case Corpus::WHITESPACE:
+            return "whitespace";
+    }
+    return "";
+}
+
+inline Corpus corpus_from_name(std::string const& name) {
+    for (Corpus corpus : all_corpora()) {
+        if (corpus_name(corpus) == name) return corpus;
+    }
+    throw InvalidArgumentException("Unknown corpus " + name);
+}
+
+// Formats tokens into a buffer, written in large chunks: io::Writer formats
+// each number through a stream, which would dominate the generation of
+// gigabytes of input.
+class ChunkedWriter {
+   private:
+    static constexpr std::size_t CHUNK_SIZE = 1 << 16;
+    // Room for the longest token.
+    static constexpr std::size_t SLACK = 64;
+
+    io::Writer& w;
+    std::unique_ptr<char[]> buffer{new char[CHUNK_SIZE + SLACK]};
+    std::size_t size = 0;
+
+    void reserve() {
+        if (size >= CHUNK_SIZE) flush();
+    }
+
+   public:
+    explicit ChunkedWriter(io::Writer& w) : w(w) {}
+    ~ChunkedWriter() { flush(); }
+
+    void flush() {
+        if (size > 0) w.write_string(buffer.get(), size);
+        size = 0;
+    }
+
+    void write_char(char c) {
+        buffer[size++] = c;
+        reserve();
+    }
+
+    template <class T>
+    void write_integer(T x) {
+        size = std::to_chars(buffer.get() + size, buffer.get() + size + SLACK,
+                             x)
+                   .ptr -
+               buffer.get();
+        reserve();
+    }
+
+    // Writes x / 10^decimals with exactly `decimals` decimals.
+    void write_fixed_point(long long x, int decimals) {
+        if (x < 0) write_char('-');
+        unsigned long long u = x < 0 ? -static_cast<unsigned long long>(x) : x;
+        unsigned long long scale = 1;
+        for (int i = 0; i < decimals; ++i) scale *= 10;
+        write_integer(u / scale);
+        write_char('.');
+        char* end = buffer.get() + size + decimals;
+        for (char* p = end - 1; p >= buffer.get() + size; --p) {
+            *p = '0' + u % 10;
+            u /= 10;
+        }
+        size += decimals;
+        reserve();
+    }
+};
+
+// Writes about `size` bytes (at least the header and one token) of the
+// corpus, deterministically for a given seed, in constant memory.
+inline void write_corpus(io::Writer& w, Corpus corpus, std::size_t size,
+                         std::uint64_t seed) {
+    gen::Random rng(seed);
+    ChunkedWriter out(w);
+    // Expected length of a token with its separator, to compute the number
+    // of tokens from the size.
+    auto count = [size](double width) {
+        return std::max<std::size_t>(1, size / width);
+    };
+    auto header = [&out](std::size_t a, std::size_t b = 0) {
+        out.write_integer(a);
+        if (b > 0) {
+            out.write_char(' ');
+            out.write_integer(b);
+        }
+        out.write_char('\n');
+    };
+    auto whitespace = [&rng, &out]() {
+        static constexpr char CHARS[] = {' ', '\t', '\n'};
+        for (int k = rng.next(1, 4); k > 0; --k) {
+            out.write_char(CHARS[rng.next(0, 2)]);
+        }
+    };
+    auto integers = [&](std::size_t n, auto next) {
+        header(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (i > 0) out.write_char(' ');
+            next();
+        }
+        out.write_char('\n');
+    };
+
+    switch (corpus) {
+        case Corpus::SMALL_INTEGERS:
+            integers(count(2.9), [&]() { out.write_integer(rng.next(0, 99)); });
+            break;
+        case Corpus::INT64:
+            integers(count(20.4), [&]() {
+                out.write_integer(static_cast<long long>(rng()));
+            });
+            break;
+        case Corpus::NEGATIVE_INTEGERS:
+            integers(count(10.9), [&]() {
+                out.write_integer(rng.next<long long>(-1000000000, -1));
+            });
+            break;
+        case Corpus::FLOATS:
+            integers(count(17.4), [&]() {
+                static constexpr long long MAX = 1000000000000000 - 1;
+                out.write_fixed_point(rng.next<long long>(-MAX, MAX), 9);
+            });
+            break;
+        case Corpus::LONG_STRINGS: {
+            static constexpr std::size_t MAX_LENGTH = 10000000;
+            std::size_t length = std::min(std::max<std::size_t>(size, 1),
+                                          MAX_LENGTH);
+            std::size_t k = count(length + 1);
+            header(k, length);
+            out.flush();
+            for (std::size_t i = 0; i < k; ++i) {
+                gen::write_random_string(w, rng, length,
+                                         "abcdefghijklmnopqrstuvwxyz");
+                out.write_char('\n');
+                out.flush();
+            }
+            break;
+        }
+        case Corpus::GRID: {
+            std::size_t side =
+                std::max<std::size_t>(1, std::sqrt(static_cast<double>(size)));
+            header(side, side);
+            out.flush();
+            for (std::size_t i = 0; i < side; ++i) {
+                gen::write_random_string(w, rng, side, ".#");
+                out.write_char('\n');
+                out.flush();
+            }
+            break;
+        }
+        case Corpus::WHITESPACE: {
+            std::size_t n = count(11.9);
+            whitespace();
+            out.write_integer(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                whitespace();
+                out.write_integer(rng.next(-1000000000, 1000000000));
+            }
+            whitespace();
+            break;
+        }
+    }
+}
+
+}  // namespace cplib::bench
@@ -0,0 +1,471 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "io.hpp"
+
+namespace cplib::chk {
+
+class WrongAnswerException : public CplibException {
+   private:
+    inline std::string prefix() const noexcept override {
+        return "WRONG ANSWER";
+    }
+
+   public:
+    WrongAnswerException(std::string const& msg) : CplibException(msg) {}
+};
+
+// Order-insensitive fingerprint of a multiset: the sum of two independent
+// keyed hashes of its elements. Two fingerprints are comparable only if they
+// were built with the same seed.
+template <class T>
+class MultisetFingerprint {
+    static_assert(std::is_integral_v<T> || std::is_same_v<T, std::string>,
+                  "Type must be integral or std::string");
+
+   private:
+    std::uint64_t key[2];
+    std::uint64_t lane[2] = {0, 0};
+    std::size_t count = 0;
+
+    static std::uint64_t hash(T const& x, std::uint64_t key) noexcept;
+
+   public:
+    explicit MultisetFingerprint(std::uint64_t seed)
+        : key{mix64(seed), mix64(~seed)} {}
+
+    void add(T const& x) noexcept {
+        lane[0] += hash(x, key[0]);
+        lane[1] += hash(x, key[1]);
+        ++count;
+    }
+
+    std::size_t size() const noexcept { return count; }
+
+    bool operator==(MultisetFingerprint const& other) const noexcept {
+        return count == other.count && lane[0] == other.lane[0] &&
+               lane[1] == other.lane[1];
+    }
+    bool operator!=(MultisetFingerprint const& other) const noexcept {
+        return !(*this == other);
+    }
+};
+
+template <class T>
+std::uint64_t MultisetFingerprint<T>::hash(T const& x,
+                                           std::uint64_t key) noexcept {
+    if constexpr (std::is_integral_v<T>) {
+        return mix64(static_cast<std::uint64_t>(x) ^ key);
+    } else {
+        return hash_bytes(x.data(), x.size(), key);
+    }
+}
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Calls `consume` on every whitespace-separated token of the reader, until EOF.
+// The reader must be strict: an integer token must be followed by whitespace
+// or EOF, so that e.g. "1abc" isn't read as 1.
+template <class T, class F>
+void for_each_token(io::Reader& r, F const& consume) {
+    for (r.skip_spaces(); !r.is_eof(); r.skip_spaces()) {
+        consume(r.read<T>());
+        if constexpr (std::is_integral_v<T>) {
+            if (!r.is_eof()) {
+                char c = r.read_char();
+                if (!is_space(c)) {
+                    throw io::UnexpectedReadException(c);
+                }
+            }
+        }
+    }
+}
+
+template <class T>
+std::vector<T> read_all_tokens(io::Reader& r) {
+    std::vector<T> v;
+    for_each_token<T>(r, [&v](T const& x) { v.push_back(x); });
+    return v;
+}
+
+// Reads the contestant output through `f`, turning any I/O error into a
+// wrong answer.
+template <class F>
+void read_contestant(F const& f) {
+    try {
+        f();
+    } catch (io::IOException const& e) {
+        throw WrongAnswerException(std::string(e.what()));
+    }
+}
+
+template <class T>
+void diagnose_unordered(std::vector<T> expected, std::vector<T> contestant) {
+    std::sort(expected.begin(), expected.end());
+    std::sort(contestant.begin(), contestant.end());
+    auto e = expected.begin(), c = contestant.begin();
+    while (e != expected.end() || c != contestant.end()) {
+        bool take_expected =
+            c == contestant.end() || (e != expected.end() && !(*c < *e));
+        T const& x = take_expected ? *e : *c;
+        auto e_next = std::upper_bound(e, expected.end(), x);
+        auto c_next = std::upper_bound(c, contestant.end(), x);
+        auto e_count = std::distance(e, e_next);
+        auto c_count = std::distance(c, c_next);
+        if (e_count != c_count) {
+            throw WrongAnswerException(
+                "Expected " + to_string(e_count) + " occurrence(s) of " +
+                to_string(x) + ", found " + to_string(c_count));
+        }
+        e = e_next;
+        c = c_next;
+    }
+}
+
+// Checks that the two files contain the same multiset of tokens, regardless
+// of their order. Both files are streamed once to compute their fingerprints;
+// only on mismatch they are read again in full to find a differing token.
+template <class T>
+void compare_unordered(const char* expected_file, const char* contestant_file,
+                       std::uint64_t seed) {
+    MultisetFingerprint<T> expected_fp(seed), contestant_fp(seed);
+    {
+        io::Reader expected(expected_file, true);
+        for_each_token<T>(expected,
+                          [&expected_fp](T const& x) { expected_fp.add(x); });
+    }
+    read_contestant([&]() {
+        io::Reader contestant(contestant_file, true);
+        for_each_token<T>(contestant, [&contestant_fp](T const& x) {
+            contestant_fp.add(x);
+        });
+    });
+    if (expected_fp == contestant_fp) {
+        return;
+    }
+    if (expected_fp.size() != contestant_fp.size()) {
+        throw WrongAnswerException(
+            "Expected " + to_string(expected_fp.size()) + " tokens, found " +
+            to_string(contestant_fp.size()));
+    }
+    io::Reader expected(expected_file, true), contestant(contestant_file, true);
+    diagnose_unordered(read_all_tokens<T>(expected),
+                       read_all_tokens<T>(contestant));
+}
+
+template <class T>
+void compare_unordered(const char* expected_file,
+                       const char* contestant_file) {
+    compare_unordered<T>(expected_file, contestant_file, random_seed());
+}
+
+inline std::string read_file(const char* file_name) {
+    std::ifstream f(file_name, std::ios::binary | std::ios::ate);
+    if (f.fail()) {
+        throw io::OpenFailureException(std::string(file_name));
+    }
+    std::string content(static_cast<std::size_t>(f.tellg()), '\0');
+    f.seekg(0);
+    f.read(content.data(), content.size());
+    return content;
+}
+
+// Length of the longest common prefix of a and b, compared a word at a time.
+inline std::size_t common_prefix(const char* a, const char* b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t x, y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        if (x != y) {
+            break;
+        }
+    }
+    while (i < n && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+// Finds the first token in which the two texts differ, and throws a
+// WrongAnswerException describing it.
+inline void diagnose_exact(std::string_view expected,
+                           std::string_view contestant) {
+    std::size_t e = 0, c = 0, line = 1;
+    auto next_token = [](std::string_view s, std::size_t& i,
+                         std::size_t* line = nullptr) {
+        for (; i < s.size() && is_space(s[i]); ++i) {
+            if (line != nullptr && s[i] == '\n') ++*line;
+        }
+        std::size_t start = i;
+        while (i < s.size() && !is_space(s[i])) ++i;
+        return s.substr(start, i - start);
+    };
+    for (std::size_t k = 1;; ++k) {
+        std::string_view x = next_token(expected, e);
+        std::string_view y = next_token(contestant, c, &line);
+        if (x.empty() && y.empty()) {
+            return;
+        }
+        if (x != y) {
+            std::string where =
+                "Token " + to_string(k) + " (line " + to_string(line) + ")";
+            if (x.empty()) {
+                throw WrongAnswerException(where + ": Expected EOF, found " +
+                                           to_string(std::string(y)));
+            }
+            if (y.empty()) {
+                throw WrongAnswerException(
+                    where + ": Expected " + to_string(std::string(x)) +
+                    ", found EOF");
+            }
+            throw WrongAnswerException(where + ": Expected " +
+                                       to_string(std::string(x)) + ", found " +
+                                       to_string(std::string(y)));
+        }
+    }
+}
+
+// Checks that the two texts have the same sequence of whitespace-separated
+// tokens. The texts are compared in bulk, treating any two runs of whitespace
+// as equal; only when they differ they are split into tokens, to report the
+// first differing one.
+inline void compare_exact(std::string_view expected,
+                          std::string_view contestant) {
+    const char* a = expected.data();
+    const char* b = contestant.data();
+    std::size_t n = expected.size(), m = contestant.size();
+    std::size_t i = 0, j = 0;
+    auto at_boundary = [](const char* s, std::size_t k, std::size_t size) {
+        return k == 0 || k == size || is_space(s[k - 1]);
+    };
+    while (i < n && is_space(a[i])) ++i;
+    while (j < m && is_space(b[j])) ++j;
+    while (true) {
+        std::size_t k = common_prefix(a + i, b + j, std::min(n - i, m - j));
+        i += k;
+        j += k;
+        if (i == n && j == m) {
+            return;
+        }
+        bool space_a = i < n && is_space(a[i]);
+        bool space_b = j < m && is_space(b[j]);
+        if (!space_a && !space_b) {
+            break;
+        }
+        while (i < n && is_space(a[i])) ++i;
+        while (j < m && is_space(b[j])) ++j;
+        if (!at_boundary(a, i, n) || !at_boundary(b, j, m)) {
+            break;
+        }
+    }
+    diagnose_exact(expected, contestant);
+}
+
+inline void compare_exact(const char* expected_file,
+                          const char* contestant_file) {
+    std::string expected = read_file(expected_file);
+    std::string contestant;
+    read_contestant([&]() { contestant = read_file(contestant_file); });
+    compare_exact(std::string_view(expected), std::string_view(contestant));
+}
+
+struct ToleranceReport {
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    std::size_t count = 0;
+    std::size_t first_violation = npos;
+    double expected_value = 0, contestant_value = 0;
+    double max_abs_error = 0;
+    // Relative to max(1, |expected|).
+    double max_rel_error = 0;
+
+    bool ok() const noexcept { return first_violation == npos; }
+};
+
+// Compares n pairs of values with tolerance |a - b| <= eps * max(1, |b|),
+// b being the expected value, and updates the report. The loop keeps
+// independent accumulators for LANES consecutive values and has no branches,
+// so that it can be vectorized; the first violation is searched for only if
+// there is one.
+inline void check_tolerance_block(const double* expected,
+                                  const double* contestant, std::size_t n,
+                                  double eps, ToleranceReport& report) {
+    static constexpr std::size_t LANES = 4;
+    double max_abs_error[LANES] = {}, max_rel_error[LANES] = {};
+    std::uint64_t violations[LANES] = {};
+    auto update = [&](std::size_t i, std::size_t lane) {
+        double error = std::fabs(contestant[i] - expected[i]);
+        double scale = std::fabs(expected[i]) > 1.0 ? std::fabs(expected[i])
+                                                    : 1.0;
+        double rel_error = error / scale;
+        max_abs_error[lane] =
+            error > max_abs_error[lane] ? error : max_abs_error[lane];
+        max_rel_error[lane] =
+            rel_error > max_rel_error[lane] ? rel_error : max_rel_error[lane];
+        violations[lane] += error > eps * scale;
+    };
+    std::size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (std::size_t lane = 0; lane < LANES; ++lane) {
+            update(i + lane, lane);
+        }
+    }
+    for (; i < n; ++i) {
+        update(i, 0);
+    }
+    std::uint64_t total_violations = 0;
+    for (std::size_t lane = 0; lane < LANES; ++lane) {
+        report.max_abs_error = std::max(report.max_abs_error,
+                                        max_abs_error[lane]);
+        report.max_rel_error = std::max(report.max_rel_error,
+                                        max_rel_error[lane]);
+        total_violations += violations[lane];
+    }
+    if (total_violations > 0 && report.ok()) {
+        for (i = 0; i < n; ++i) {
+            double error = std::fabs(contestant[i] - expected[i]);
+            if (error > eps * std::max(1.0, std::fabs(expected[i]))) {
+                report.first_violation = report.count + i;
+                report.expected_value = expected[i];
+                report.contestant_value = contestant[i];
+                break;
+            }
+        }
+    }
+    report.count += n;
+}
+
+// Parses up to n real numbers from s, starting at position i.
+// Returns the number of values parsed, which is less than n only at the end
+// of the text.
+inline std::size_t parse_floating_point_block(std::string_view s,
+                                              std::size_t& i, double* values,
+                                              std::size_t n) {
+    std::size_t k = 0;
+    while (k < n) {
+        while (i < s.size() && is_space(s[i])) ++i;
+        if (i == s.size()) {
+            break;
+        }
+        std::size_t end = i;
+        while (end < s.size() && !is_space(s[end])) ++end;
+        auto [ptr, ec] =
+            std::from_chars(s.data() + i, s.data() + end, values[k]);
+        if (ec != std::errc() || ptr != s.data() + end ||
+            !std::isfinite(values[k])) {
+            throw io::UnexpectedReadException(
+                "a real number, found " +
+                to_string(std::string(s.substr(i, end - i))));
+        }
+        i = end;
+        ++k;
+    }
+    return k;
+}
+
+// Compares two sequences of real numbers, parsed a block at a time, and
+// returns the first value exceeding the tolerance together with error
+// statistics. Throws a WrongAnswerException if the contestant output is
+// malformed or doesn't have as many values as the expected one.
+inline ToleranceReport compare_floating_point(std::string_view expected,
+                                              std::string_view contestant,
+                                              double eps) {
+    static constexpr std::size_t BLOCK = 4096;
+    struct alignas(64) Block {
+        double values[BLOCK];
+    };
+    auto expected_block = std::make_unique<Block>();
+    auto contestant_block = std::make_unique<Block>();
+
+    ToleranceReport report;
+    std::size_t e = 0, c = 0;
+    while (true) {
+        std::size_t n = parse_floating_point_block(
+            expected, e, expected_block->values, BLOCK);
+        std::size_t m;
+        read_contestant([&]() {
+            m = parse_floating_point_block(contestant, c,
+                                           contestant_block->values, BLOCK);
+        });
+        if (n != m) {
+            throw WrongAnswerException(
+                "Expected " + to_string(report.count + n) + " values, found " +
+                (m < n ? to_string(report.count + m) : "more"));
+        }
+        check_tolerance_block(expected_block->values, contestant_block->values,
+                              n, eps, report);
+        if (n < BLOCK) {
+            return report;
+        }
+    }
+}
+
+inline ToleranceReport compare_floating_point(const char* expected_file,
+                                              const char* contestant_file,
+                                              double eps) {
+    std::string expected = read_file(expected_file);
+    std::string contestant;
+    read_contestant([&]() { contestant = read_file(contestant_file); });
+    return compare_floating_point(std::string_view(expected),
+                                  std::string_view(contestant), eps);
+}
+
+struct Verdict {
+    double score = 0;
+    std::string message;
+    // Set when the checker itself failed, rather than the contestant.
+    bool error = false;
+};
+
+// Runs `check`, turning its outcome into a verdict. Any exception other than
+// WrongAnswerException is propagated.
+template <class F>
+Verdict judge(F const& check) {
+    try {
+        check();
+    } catch (WrongAnswerException const& e) {
+        return {0.0, e.what()};
+    }
+    return {1.0, "Output is correct"};
+}
+
+// Entry point for checkers, following the CMS convention: the checker is
+// invoked as `checker <input> <expected output> <contestant output>`, prints
+// the score on stdout and a message on stderr. Any exception other than
+// WrongAnswerException is not caught and will make the checker crash.
+inline int run(int argc, char** argv,
+               std::function<void(const char* input_file,
+                                  const char* expected_file,
+                                  const char* contestant_file)> const& check) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <input> <expected output> <contestant output>"
+                  << std::endl;
+        return 1;
+    }
+    Verdict verdict = judge([&]() { check(argv[1], argv[2], argv[3]); });
+    std::cout << std::fixed << std::setprecision(1) << verdict.score
+              << std::endl;
+    std::cerr << verdict.message << std::endl;
+    return 0;
+}
+
+}  // namespace cplib::chk
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "checker.hpp"
+#include "thread_pool.hpp"
+
+namespace cplib::chk {
+
+// A long-lived checker evaluating many submissions concurrently.
+//
+// Each testcase (input and expected output) is parsed once into a `Test` and
+// cached in memory, keyed by the hash of the content of the two files; the
+// contestant outputs are then checked against it on a pool of threads.
+// The cache is never evicted: a service is meant to live as long as a contest.
+template <class Test>
+class Service {
+   public:
+    using Parser = std::function<Test(std::string const& input,
+                                      std::string const& expected)>;
+    using Check =
+        std::function<void(Test const& test, std::string_view contestant)>;
+
+   private:
+    Parser parse;
+    Check check;
+    std::uint64_t key = random_seed();
+
+    std::mutex cache_mutex;
+    std::unordered_map<std::uint64_t,
+                       std::shared_future<std::shared_ptr<const Test>>>
+        cache;
+
+    // Declared last, so that it's destroyed (and its tasks completed)
+    // before the other members.
+    ThreadPool pool;
+
+    std::shared_ptr<const Test> get_test(std::string const& input_file,
+                                         std::string const& expected_file);
+
+    Verdict evaluate(std::string const& input_file,
+                     std::string const& expected_file,
+                     std::string const& contestant_file);
+
+    static void write_result(std::filesystem::path const& path,
+                             Verdict const& verdict);
+
+   public:
+    Service(Parser parse, Check check, std::size_t n_threads = 0)
+        : parse(std::move(parse)), check(std::move(check)), pool(n_threads) {}
+
+    std::future<Verdict> submit(std::string input_file,
+                                std::string expected_file,
+                                std::string contestant_file);
+
+    std::size_t cached_tests();
+
+    void serve(std::string const& queue_dir,
+               std::chrono::milliseconds poll_interval =
+                   std::chrono::milliseconds(50));
+};
+
+template <class Test>
+std::shared_ptr<const Test> Service<Test>::get_test(
+    std::string const& input_file, std::string const& expected_file) {
+    std::string input = read_file(input_file.c_str());
+    std::string expected = read_file(expected_file.c_str());
+    std::uint64_t hash =
+        mix64(hash_bytes(input.data(), input.size(), key)) ^
+        hash_bytes(expected.data(), expected.size(), ~key);
+
+    std::promise<std::shared_ptr<const Test>> promise;
+    std::shared_future<std::shared_ptr<const Test>> test;
+    bool owner = false;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = cache.find(hash);
+        if (it == cache.end()) {
+            it = cache.emplace(hash, promise.get_future().share()).first;
+            owner = true;
+        }
+        test = it->second;
+    }
+    if (owner) {
+        try {
+            promise.set_value(
+                std::make_shared<const Test>(parse(input, expected)));
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            cache.erase(hash);
+        }
+    }
+    return test.get();
+}
+
+template <class Test>
+Verdict Service<Test>::evaluate(std::string const& input_file,
+                                std::string const& expected_file,
+                                std::string const& contestant_file) {
+    try {
+        auto test = get_test(input_file, expected_file);
+        return judge([&]() {
+            std::string contestant;
+            read_contestant(
+                [&]() { contestant = read_file(contestant_file.c_str()); });
+            check(*test, contestant);
+        });
+    } catch (std::exception const& e) {
+        return {0.0, e.what(), true};
+    }
+}
+
+template <class Test>
+std::future<Verdict> Service<Test>::submit(std::string input_file,
+                                           std::string expected_file,
+                                           std::string contestant_file) {
+    return pool.submit([this, input_file, expected_file, contestant_file]() {
+        return evaluate(input_file, expected_file, contestant_file);
+    });
+}
+
+template <class Test>
+std::size_t Service<Test>::cached_tests() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return cache.size();
+}
+
+template <class Test>
+void Service<Test>::write_result(std::filesystem::path const& path,
+                                 Verdict const& verdict) {
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream f(tmp);
+        if (verdict.error) {
+            f << "ERROR\n";
+        } else {
+            f << std::fixed << std::setprecision(1) << verdict.score << "\n";
+        }
+        f << verdict.message << "\n";
+        if (!f) {
+            throw io::IOException("Couldn't write " + tmp.string());
+        }
+    }
+    std::filesystem::rename(tmp, path);
+}
+
+// Serves the job queue in `queue_dir`. A job is a file `<name>.job` made of
+// three lines: the paths of the input, of the expected output and of the
+// contestant output. The job is claimed by renaming it to `<name>.running`;
+// when done, the verdict is written to `<name>.result` as two lines — the
+// score (or ERROR) and the message — and the `.running` file is removed.
+// If that fails, the error is logged to stderr and an ERROR result is written
+// if possible.
+//
+// Jobs are picked up as soon as they appear, so a producer must not write a
+// `.job` file in place: it must write `<name>.tmp` and rename it to
+// `<name>.job` once complete (rename is atomic within a directory).
+// The service returns once a file named `stop` exists in the directory and
+// all the pending jobs are completed.
+template <class Test>
+void Service<Test>::serve(std::string const& queue_dir,
+                          std::chrono::milliseconds poll_interval) {
+    namespace fs = std::filesystem;
+    std::list<std::future<void>> running;
+    while (true) {
+        std::vector<fs::path> jobs;
+        for (auto const& entry : fs::directory_iterator(queue_dir)) {
+            if (entry.path().extension() == ".job") {
+                jobs.push_back(entry.path());
+            }
+        }
+        std::sort(jobs.begin(), jobs.end());
+        for (fs::path const& job : jobs) {
+            fs::path claimed = fs::path(job).replace_extension(".running");
+            std::error_code ec;
+            fs::rename(job, claimed, ec);
+            if (ec) {
+                // Claimed by someone else.
+                continue;
+            }
+            std::string input, expected, contestant;
+            {
+                std::ifstream f(claimed);
+                std::getline(f, input);
+                std::getline(f, expected);
+                std::getline(f, contestant);
+            }
+            running.push_back(pool.submit([this, claimed, input, expected,
+                                           contestant]() {
+                fs::path result = claimed;
+                result.replace_extension(".result");
+                std::string error;
+                try {
+                    write_result(result, evaluate(input, expected, contestant));
+                } catch (std::exception const& e) {
+                    error = e.what();
+                } catch (...) {
+                    error = "Unknown exception";
+                }
+                if (!error.empty()) {
+                    std::cerr << "Job " << claimed.string()
+                              << " failed: " << error << std::endl;
+                    try {
+                        write_result(result, {0.0, error, true});
+                    } catch (std::exception const& e) {
+                        std::cerr << "Job " << claimed.string()
+                                  << " has no result: " << e.what()
+                                  << std::endl;
+                    }
+                }
+                std::error_code ec;
+                fs::remove(claimed, ec);
+            }));
+        }
+        running.remove_if([](std::future<void> const& f) {
+            return f.wait_for(std::chrono::seconds(0)) ==
+                   std::future_status::ready;
+        });
+        if (jobs.empty()) {
+            if (running.empty() && fs::exists(fs::path(queue_dir) / "stop")) {
+                return;
+            }
+            std::this_thread::sleep_for(poll_interval);
+        }
+    }
+}
+
+}  // namespace cplib::chk
@@ -1,8 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <exception>
+#include <initializer_list>
 #include <limits>
+#include <memory>
+#include <random>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+
+// With CPLIB_PROFILE defined, the main loops of the library (reading arrays,
+// checking them) are measured as profiling regions, see profiling.hpp.
+#ifdef CPLIB_PROFILE
+#include "profiling.hpp"
+#define CPLIB_PROFILE_REGION(name) \
+    ::cplib::prof::Region cplib_profile_region_(name)
+#else
+#define CPLIB_PROFILE_REGION(name)
+#endif
+
+// The library is header-only by default, with the non-template functions
+// defined inline in the headers. With CPLIB_COMPILED defined, the headers of
+// the core (common.hpp, io.hpp, validation.hpp) only declare them, along with
+// the instantiations of the templates for the common types, and they are
+// compiled once in src/cplib.cpp, which also defines CPLIB_IMPLEMENTATION.
+#if defined(CPLIB_COMPILED) && !defined(CPLIB_IMPLEMENTATION)
+#define CPLIB_DECLARATIONS_ONLY
+#endif
+#ifdef CPLIB_IMPLEMENTATION
+#define CPLIB_INLINE
+#else
+#define CPLIB_INLINE inline
+#endif
+
+// The compiled library and the code using it must agree on CPLIB_PROFILE,
+// otherwise the regions of the library would silently be missing (or be
+// measured unexpectedly). The library defines a symbol named after the flag,
+// which code using it refers to: a mismatch fails to link. Likewise, without
+// CPLIB_COMPILED, all the translation units of a program must agree on it.
+#ifdef CPLIB_PROFILE
+#define CPLIB_BUILD_FLAGS library_built_with_CPLIB_PROFILE
+#else
+#define CPLIB_BUILD_FLAGS library_built_without_CPLIB_PROFILE
+#endif
+namespace cplib::detail {
+extern const int CPLIB_BUILD_FLAGS;
+#ifdef CPLIB_DECLARATIONS_ONLY
+[[gnu::used]] static const int* const check_build_flags = &CPLIB_BUILD_FLAGS;
+#endif
+}  // namespace cplib::detail
 
 namespace cplib {
 
@@ -12,26 +63,161 @@ struct Limits {
     static const T MAX = std::numeric_limits<T>::max();
 };
 
+// A string with static storage duration (e.g. a string literal), which can be
+// referred to rather than copied.
+struct StaticString {
+    const char* s;
+
+    template <std::size_t N>
+    explicit constexpr StaticString(const char (&s)[N]) noexcept : s(s) {}
+};
+
+// The exceptions are thrown on the error paths of readers and checkers, which
+// may be taken often (e.g. by a checker that probes the output and catches),
+// so constructing and copying them doesn't allocate: they store the fields of
+// their message, which is only formatted by the first call to what(). A
+// message made of static strings (string literals) and up to three arguments
+// is stored as such; any other message is formatted upfront. Either way, the
+// formatted message is kept in a reference-counted string.
 class CplibException : public std::exception {
+   protected:
+    // An argument of a structured message.
+    class Arg {
+       private:
+        enum class Type : std::uint8_t {
+            NONE,
+            CHAR,
+            SIGNED,
+            UNSIGNED,
+            REAL,
+            TEXT
+        };
+        Type type = Type::NONE;
+        union {
+            char c;
+            long long i;
+            unsigned long long u;
+            double x;
+            const char* s;
+        };
+
+       public:
+        Arg() noexcept : u(0) {}
+        Arg(char c) noexcept : type(Type::CHAR), c(c) {}
+        // `s` must be a static string.
+        Arg(const char* s) noexcept : type(Type::TEXT), s(s) {}
+        template <class T,
+                  std::enable_if_t<std::is_arithmetic_v<T> &&
+                                       !std::is_same_v<T, char>,
+                                   bool> = true>
+        Arg(T value) noexcept {
+            if constexpr (std::is_floating_point_v<T>) {
+                type = Type::REAL;
+                x = value;
+            } else if constexpr (std::is_signed_v<T>) {
+                type = Type::SIGNED;
+                i = value;
+            } else {
+                type = Type::UNSIGNED;
+                u = value;
+            }
+        }
+
+        // Appends the argument as std::to_string would format it (or the
+        // character itself).
+        void append_to(std::string& out) const;
+    };
+
    private:
-    const std::string msg_with_prefix;
+    static constexpr int N_ARGS = 3;
+
+    // Static parts of the message, interleaved with the arguments: if null,
+    // the message is msg.
+    const char* parts[N_ARGS + 1] = {};
+    Arg args[N_ARGS];
+    // Set once, by the constructor or by what(), and only accessed
+    // atomically.
+    mutable std::shared_ptr<const std::string> msg;
 
     inline virtual std::string prefix() const noexcept { return "GENERIC"; }
-    inline std::string add_prefix(std::string const& msg) const noexcept {
-        return prefix() + ": " + msg;
-    }
 
    protected:
-    const std::string msg;
+    // The message parts[0] args[0] parts[1] args[1] ..., where the parts are
+    // static strings.
+    CplibException(std::initializer_list<const char*> parts,
+                   std::initializer_list<Arg> args) noexcept;
 
    public:
     explicit CplibException() = default;
     explicit CplibException(std::string const& msg)
-        : msg_with_prefix(add_prefix(msg)), msg(msg) {}
+        : msg(std::make_shared<const std::string>(msg)) {}
 
-    const char* what() const noexcept override { return msg.c_str(); }
+    // The result is valid as long as the exception (or a copy made after the
+    // call) isn't destroyed or assigned to.
+    const char* what() const noexcept override;
 };
 
+#ifndef CPLIB_DECLARATIONS_ONLY
+CPLIB_INLINE void CplibException::Arg::append_to(std::string& out) const {
+    char buffer[24];
+    switch (type) {
+        case Type::NONE:
+            return;
+        case Type::CHAR:
+            out += c;
+            return;
+        case Type::SIGNED:
+            out.append(buffer, std::to_chars(buffer, buffer + 24, i).ptr);
+            return;
+        case Type::UNSIGNED:
+            out.append(buffer, std::to_chars(buffer, buffer + 24, u).ptr);
+            return;
+        case Type::TEXT:
+            out += s;
+            return;
+        case Type::REAL:
+            out += std::to_string(x);
+            return;
+    }
+}
+
+CPLIB_INLINE CplibException::CplibException(
+    std::initializer_list<const char*> parts,
+    std::initializer_list<Arg> args) noexcept {
+    std::copy_n(parts.begin(), std::min<std::size_t>(parts.size(), N_ARGS + 1),
+                this->parts);
+    std::copy_n(args.begin(), std::min<std::size_t>(args.size(), N_ARGS),
+                this->args);
+}
+
+// Threads calling what() at once may all format the message, but they agree
+// on the one that is kept.
+CPLIB_INLINE const char* CplibException::what() const noexcept {
+    std::shared_ptr<const std::string> formatted = std::atomic_load(&msg);
+    if (formatted != nullptr) {
+        return formatted->c_str();
+    }
+    if (parts[0] == nullptr) {
+        return "";
+    }
+    try {
+        std::string message;
+        for (int k = 0; k <= N_ARGS && parts[k] != nullptr; ++k) {
+            message += parts[k];
+            if (k < N_ARGS) args[k].append_to(message);
+        }
+        std::shared_ptr<const std::string> unset;
+        formatted = std::make_shared<const std::string>(std::move(message));
+        if (!std::atomic_compare_exchange_strong(&msg, &unset, formatted)) {
+            formatted = unset;
+        }
+        return formatted->c_str();
+    } catch (std::bad_alloc const&) {
+        return parts[0];
+    }
+}
+#endif
+
 class InvalidArgumentException : public CplibException {
    private:
     inline std::string prefix() const noexcept override {
@@ -49,9 +235,19 @@ class FailedValidationException : public CplibException {
     }
 
    public:
+    // Bounds are printed as numbers (as by std::to_string), even if they are
+    // characters. Only a StaticString name is stored without being copied.
     template <class T>
-    static FailedValidationException interval_constraint(std::string var, T low,
+    static FailedValidationException interval_constraint(StaticString var,
+                                                         T low,
                                                          T high) noexcept {
+        return FailedValidationException({"Expected ", " <= ", " <= ", ""},
+                                         {+low, var.s, +high});
+    }
+
+    template <class T>
+    static FailedValidationException interval_constraint(
+        std::string const& var, T low, T high) {
         return FailedValidationException("Expected " + std::to_string(low) +
                                          " <= " + var +
                                          " <= " + std::to_string(high));
@@ -59,13 +255,46 @@ class FailedValidationException : public CplibException {
 
     FailedValidationException(std::string const& msg) : CplibException(msg) {}
 
+   protected:
+    using CplibException::CplibException;
+
+   public:
+
     std::string what_with_line(const char* file,
                                unsigned int line) const noexcept {
         return "FAILED VALIDATION AT " + std::string(file) +
-               "::" + std::to_string(line) + "\n---\n" + msg + "\n---";
+               "::" + std::to_string(line) + "\n---\n" + what() + "\n---";
     }
 };
 
+inline std::uint64_t random_seed() {
+    std::random_device rd;
+    return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+}
+
+// SplitMix64 finalizer: a fast bijective mixing function on 64-bit words.
+inline std::uint64_t mix64(std::uint64_t x) noexcept {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Keyed hash of a sequence of bytes, processed a 64-bit word at a time.
+inline std::uint64_t hash_bytes(const char* data, std::size_t n,
+                                std::uint64_t key) noexcept {
+    std::uint64_t h = key ^ n;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        h = mix64(h ^ word);
+    }
+    std::uint64_t tail = 0;
+    std::memcpy(&tail, data + i, n - i);
+    return mix64(h ^ tail ^ key);
+}
+
 template <class T,
           std::enable_if_t<std::is_convertible_v<std::decay_t<T>, std::string>,
                            bool> = true>
@@ -73,9 +302,7 @@ std::string to_string(T const& x) {
     return "\"" + static_cast<std::string>(x) + "\"";
 }
 
-std::string to_string(char c) {
-    return std::string(1, c);
-}
+inline std::string to_string(char c) { return std::string(1, c); }
 
 template <class T, class = decltype(std::to_string(std::declval<T>())),
           std::enable_if_t<!std::is_same_v<std::decay_t<T>, char>, bool> = true>
@@ -0,0 +1,17 @@
+// The compiled cplib library: the definitions of the non-template functions
+// of the core headers, and the instantiations of their templates for the
+// common types, which the headers only declare with CPLIB_COMPILED.
+
+#ifndef CPLIB_COMPILED
+#define CPLIB_COMPILED
+#endif
+#define CPLIB_IMPLEMENTATION
+
+#include "common.hpp"
+#include "interning.hpp"
+#include "io.hpp"
+#include "validation.hpp"
+
+namespace cplib::detail {
+extern const int CPLIB_BUILD_FLAGS = 0;
+}  // namespace cplib::detail
@@ -0,0 +1,21 @@
+// Precompiled header for validators and checkers built against the compiled
+// cplib library: precompile it with the same flags as the programs, e.g.
+//
+//     g++ -std=c++17 -O2 -DCPLIB_COMPILED -x c++-header cplib_pch.hpp
+//
+// and include it first (or pass -include cplib_pch.hpp). It has no include
+// guard, since it is compiled as a main file; the headers it includes do.
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "common.hpp"
+#include "interning.hpp"
+#include "io.hpp"
+#include "validation.hpp"
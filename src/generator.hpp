@@ -0,0 +1,557 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "io.hpp"
+#include "thread_pool.hpp"
+
+namespace cplib::gen {
+
+// xoshiro256** pseudo-random generator. Satisfies the requirements of
+// UniformRandomBitGenerator, so it can also be used with <random>.
+//
+// jump() advances the state by 2^128 steps: split() uses it to derive
+// independent, non-overlapping generators from a single seed.
+class Random {
+   private:
+    std::uint64_t s[4];
+
+    static inline std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+   public:
+    using result_type = std::uint64_t;
+
+    explicit Random(std::uint64_t seed = 0) {
+        for (int i = 0; i < 4; ++i) {
+            s[i] = mix64(seed + i * 0x9e3779b97f4a7c15ULL);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() noexcept {
+        std::uint64_t result = rotl(s[1] * 5, 7) * 9;
+        std::uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    void jump() noexcept;
+
+    // Returns a copy of this generator, then jumps ahead.
+    Random split() noexcept {
+        Random r = *this;
+        jump();
+        return r;
+    }
+
+    // Uniform integer in [low, high], without modulo bias.
+    template <class T>
+    T next(T low, T high);
+
+    // Uniform real number in [0, 1).
+    double next_real() noexcept { return ((*this)() >> 11) * 0x1.0p-53; }
+
+    template <class It>
+    void shuffle(It const& begin, It const& end);
+};
+
+inline void Random::jump() noexcept {
+    static constexpr std::uint64_t JUMP[] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL,
+        0x39abdc4529b1661cULL};
+    std::uint64_t t[4] = {0, 0, 0, 0};
+    for (std::uint64_t jump : JUMP) {
+        for (int b = 0; b < 64; ++b) {
+            if (jump & (1ULL << b)) {
+                for (int i = 0; i < 4; ++i) t[i] ^= s[i];
+            }
+            (*this)();
+        }
+    }
+    for (int i = 0; i < 4; ++i) s[i] = t[i];
+}
+
+template <class T>
+T Random::next(T low, T high) {
+    static_assert(std::is_integral_v<T>, "Type must be integral");
+    if (high < low) {
+        throw InvalidArgumentException("Empty range [" + to_string(low) +
+                                       ", " + to_string(high) + "]");
+    }
+    // Differences and sums are cast back to U: for types narrower than int,
+    // the operands are promoted to (signed) int.
+    using U = std::make_unsigned_t<T>;
+    std::uint64_t range =
+        static_cast<U>(static_cast<U>(high) - static_cast<U>(low));
+    if (range == std::numeric_limits<std::uint64_t>::max()) {
+        return static_cast<T>((*this)());
+    }
+    // Lemire's multiply-and-reject method.
+    std::uint64_t n = range + 1;
+    __uint128_t m = static_cast<__uint128_t>((*this)()) * n;
+    if (static_cast<std::uint64_t>(m) < n) {
+        std::uint64_t threshold = -n % n;
+        while (static_cast<std::uint64_t>(m) < threshold) {
+            m = static_cast<__uint128_t>((*this)()) * n;
+        }
+    }
+    return static_cast<T>(static_cast<U>(
+        static_cast<U>(low) +
+        static_cast<U>(static_cast<std::uint64_t>(m >> 64))));
+}
+
+template <class It>
+void Random::shuffle(It const& begin, It const& end) {
+    auto n = std::distance(begin, end);
+    for (decltype(n) i = n - 1; i > 0; --i) {
+        std::iter_swap(std::next(begin, i),
+                       std::next(begin, next<decltype(n)>(0, i)));
+    }
+}
+
+// A pseudo-random permutation of {first, ..., first + n - 1}, requiring
+// constant memory: the i-th element is computed in (expected) O(1) time as
+// the image of i through a keyed bijection.
+//
+// The bijection is a Feistel network on the smallest domain of 2^(2k) >= n
+// elements, with cycle walking to restrict it to [0, n): since the domain has
+// less than 4n elements, each access takes less than 4 evaluations of the
+// network on average.
+class RandomPermutation {
+   public:
+    class Iterator {
+       private:
+        RandomPermutation const* p;
+        std::uint64_t i;
+
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::uint64_t;
+        using difference_type = std::int64_t;
+        using pointer = void;
+        using reference = std::uint64_t;
+
+        Iterator(RandomPermutation const* p, std::uint64_t i) : p(p), i(i) {}
+
+        std::uint64_t operator*() const { return (*p)[i]; }
+        Iterator& operator++() {
+            ++i;
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator it = *this;
+            ++i;
+            return it;
+        }
+        bool operator==(Iterator const& other) const { return i == other.i; }
+        bool operator!=(Iterator const& other) const { return i != other.i; }
+    };
+
+   private:
+    static constexpr int ROUNDS = 6;
+
+    std::uint64_t n;
+    std::uint64_t first;
+    int half_bits = 0;
+    std::uint64_t mask;
+    std::uint64_t keys[ROUNDS];
+
+    std::uint64_t encrypt(std::uint64_t x) const noexcept {
+        std::uint64_t left = x >> half_bits, right = x & mask;
+        for (std::uint64_t key : keys) {
+            std::uint64_t f = mix64(right ^ key) & mask;
+            left ^= f;
+            std::swap(left, right);
+        }
+        return (left << half_bits) | right;
+    }
+
+   public:
+    RandomPermutation(std::uint64_t n, Random& rng, std::uint64_t first = 0)
+        : n(n), first(first) {
+        while (half_bits < 32 && (1ULL << (2 * half_bits)) < n) {
+            ++half_bits;
+        }
+        mask = (1ULL << half_bits) - 1;
+        for (std::uint64_t& key : keys) {
+            key = rng();
+        }
+    }
+
+    std::uint64_t size() const noexcept { return n; }
+
+    std::uint64_t operator[](std::uint64_t i) const noexcept {
+        std::uint64_t x = encrypt(i);
+        while (x >= n) {
+            x = encrypt(x);
+        }
+        return first + x;
+    }
+
+    Iterator begin() const noexcept { return Iterator(this, 0); }
+    Iterator end() const noexcept { return Iterator(this, n); }
+};
+
+// A bounded in-memory pipe, carrying chunks of bytes from a producer thread
+// (through a PipeOStream) to a consumer thread (through a PipeIStream).
+class Pipe {
+   public:
+    using Chunk = std::shared_ptr<const std::string>;
+
+   private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Chunk> chunks;
+    std::size_t capacity;
+    bool closed = false;
+    bool abandoned = false;
+
+   public:
+    explicit Pipe(std::size_t capacity = 16) : capacity(capacity) {}
+
+    // Blocks while the pipe is full. Returns false (dropping the chunk) if the
+    // consumer abandoned the pipe.
+    bool push(Chunk chunk);
+    // Blocks while the pipe is empty. Returns nullptr once the pipe is closed
+    // and empty.
+    Chunk pop();
+
+    // Called by the producer when it's done.
+    void close();
+    // Called by the consumer when it's done, to unblock the producer.
+    void abandon();
+};
+
+inline bool Pipe::push(Chunk chunk) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this]() { return abandoned || chunks.size() < capacity; });
+    if (abandoned) {
+        return false;
+    }
+    chunks.push_back(std::move(chunk));
+    cv.notify_all();
+    return true;
+}
+
+inline Pipe::Chunk Pipe::pop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this]() { return closed || !chunks.empty(); });
+    if (chunks.empty()) {
+        return nullptr;
+    }
+    Chunk chunk = std::move(chunks.front());
+    chunks.pop_front();
+    cv.notify_all();
+    return chunk;
+}
+
+inline void Pipe::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    cv.notify_all();
+}
+
+inline void Pipe::abandon() {
+    std::lock_guard<std::mutex> lock(mutex);
+    abandoned = true;
+    chunks.clear();
+    cv.notify_all();
+}
+
+// Thrown by a PipeOStream once the consumer abandoned its pipe, to stop the
+// producer.
+class PipeAbandonedException : public io::IOException {
+   public:
+    PipeAbandonedException() : io::IOException("Pipe abandoned") {}
+};
+
+// Output stream writing to a Pipe, to be passed to an io::Writer. The chunks
+// sent through the pipe are also written to `copy`, if given. Writing to an
+// abandoned pipe throws PipeAbandonedException.
+class PipeOStream : public std::ostream {
+   private:
+    class Buffer : public std::streambuf {
+       private:
+        static constexpr std::size_t CHUNK_SIZE = 1 << 16;
+
+        Pipe& pipe;
+        std::ostream* copy;
+        std::string chunk;
+
+        void send() {
+            if (chunk.empty()) return;
+            if (copy != nullptr) {
+                copy->write(chunk.data(), chunk.size());
+            }
+            auto c = std::make_shared<const std::string>(std::move(chunk));
+            chunk.clear();
+            chunk.reserve(CHUNK_SIZE);
+            if (!pipe.push(std::move(c))) {
+                throw PipeAbandonedException();
+            }
+        }
+
+       protected:
+        int_type overflow(int_type c) override {
+            if (c != traits_type::eof()) {
+                chunk.push_back(traits_type::to_char_type(c));
+                if (chunk.size() >= CHUNK_SIZE) send();
+            }
+            return traits_type::not_eof(c);
+        }
+        std::streamsize xsputn(const char* s, std::streamsize n) override {
+            chunk.append(s, n);
+            if (chunk.size() >= CHUNK_SIZE) send();
+            return n;
+        }
+        int sync() override {
+            send();
+            return 0;
+        }
+
+       public:
+        Buffer(Pipe& pipe, std::ostream* copy) : pipe(pipe), copy(copy) {
+            chunk.reserve(CHUNK_SIZE);
+        }
+        ~Buffer() {
+            try {
+                send();
+            } catch (PipeAbandonedException const&) {
+            }
+        }
+    } buffer;
+
+   public:
+    explicit PipeOStream(Pipe& pipe, std::ostream* copy = nullptr)
+        : std::ostream(nullptr), buffer(pipe, copy) {
+        rdbuf(&buffer);
+        // Let the exceptions of the buffer through.
+        exceptions(std::ios::badbit);
+    }
+};
+
+// Input stream reading from a Pipe, to be passed to an io::Reader.
+class PipeIStream : public std::istream {
+   private:
+    class Buffer : public std::streambuf {
+       private:
+        Pipe& pipe;
+        Pipe::Chunk chunk;
+
+       protected:
+        int_type underflow() override {
+            do {
+                chunk = pipe.pop();
+                if (chunk == nullptr) {
+                    return traits_type::eof();
+                }
+            } while (chunk->empty());
+            char* data = const_cast<char*>(chunk->data());
+            setg(data, data, data + chunk->size());
+            return traits_type::to_int_type(data[0]);
+        }
+
+       public:
+        explicit Buffer(Pipe& pipe) : pipe(pipe) {}
+    } buffer;
+
+   public:
+    explicit PipeIStream(Pipe& pipe) : std::istream(nullptr), buffer(pipe) {
+        rdbuf(&buffer);
+    }
+};
+
+// Generates the tests of a task in parallel.
+//
+// Each test is a function writing the test through an io::Writer, using the
+// Random generator it is given. The generators are derived from the seed of
+// the driver by splitting, in the order in which the tests were added, so that
+// the output doesn't depend on the number of threads or on scheduling.
+// If a validator is set, each test is validated right after being written.
+// If a stream validator is set instead, each test is validated while it's
+// being generated, through a Pipe, and written to file only if valid.
+class Driver {
+   public:
+    using Generator = std::function<void(Random&, io::Writer&)>;
+    using Validator = std::function<void(const char* file_name)>;
+    using StreamValidator = std::function<void(io::Reader&)>;
+
+    struct Result {
+        std::string file_name;
+        bool success;
+        std::string message;
+    };
+
+   private:
+    struct Spec {
+        std::string file_name;
+        Generator generate;
+    };
+
+    std::uint64_t seed;
+    std::size_t n_threads;
+    Validator validate;
+    StreamValidator stream_validate;
+    std::vector<Spec> specs;
+
+    Result run_one(Spec const& spec, Random rng) const;
+
+   public:
+    explicit Driver(std::uint64_t seed, std::size_t n_threads = 0)
+        : seed(seed), n_threads(n_threads) {}
+
+    Driver& with_validator(Validator validate) {
+        this->validate = std::move(validate);
+        this->stream_validate = nullptr;
+        return *this;
+    }
+
+    Driver& with_stream_validator(StreamValidator validate) {
+        this->stream_validate = std::move(validate);
+        this->validate = nullptr;
+        return *this;
+    }
+
+    Driver& add(std::string file_name, Generator generate) {
+        specs.push_back({std::move(file_name), std::move(generate)});
+        return *this;
+    }
+
+    // Binds the given parameters to a generator function such as
+    // `void gen_tree(Random&, io::Writer&, int n, int max_degree)`.
+    template <class F, class... Args>
+    Driver& add(std::string file_name, F generate, Args... args) {
+        return add(std::move(file_name),
+                   Generator([generate, args...](Random& rng, io::Writer& w) {
+                       generate(rng, w, args...);
+                   }));
+    }
+
+    std::vector<Result> run() const;
+};
+
+// Runs the generator on a separate thread, feeding the validator (which is
+// given a strict Reader) through a bounded Pipe, so that memory is bounded
+// regardless of the size of the test. The output is streamed to a temporary
+// file next to `file_name`, which is renamed to `file_name` only if both
+// succeed. If the validator fails, the generator is stopped.
+inline Driver::Result generate_and_validate(
+    std::string const& file_name, Driver::Generator const& generate,
+    Random rng, Driver::StreamValidator const& validate,
+    std::size_t capacity = 16) {
+    std::string temp_name = file_name + ".tmp";
+    std::ofstream file(temp_name, std::ios::binary);
+    if (!file) {
+        return {file_name, false, "Couldn't write " + temp_name};
+    }
+    Pipe pipe(capacity);
+    std::string generator_error;
+    std::thread producer([&]() {
+        try {
+            io::Writer w(*new PipeOStream(pipe, &file));
+            generate(rng, w);
+        } catch (PipeAbandonedException const&) {
+        } catch (std::exception const& e) {
+            generator_error = e.what();
+        }
+        pipe.close();
+    });
+    std::string validator_error;
+    try {
+        io::Reader r(*new PipeIStream(pipe), /* strict */ true);
+        validate(r);
+        // Let the generator finish, in case the validator stopped reading
+        // early.
+        while (pipe.pop() != nullptr) {
+        }
+    } catch (std::exception const& e) {
+        validator_error = e.what();
+    }
+    pipe.abandon();
+    producer.join();
+    file.close();
+
+    std::string error = generator_error;
+    if (error.empty()) {
+        error = validator_error;
+    }
+    if (error.empty() && file.fail()) {
+        error = "Couldn't write " + temp_name;
+    }
+    if (error.empty() &&
+        std::rename(temp_name.c_str(), file_name.c_str()) != 0) {
+        error = "Couldn't rename " + temp_name + " to " + file_name;
+    }
+    if (!error.empty()) {
+        std::remove(temp_name.c_str());
+        return {file_name, false, error};
+    }
+    return {file_name, true, "OK"};
+}
+
+inline Driver::Result Driver::run_one(Spec const& spec, Random rng) const {
+    if (stream_validate) {
+        return generate_and_validate(spec.file_name, spec.generate, rng,
+                                     stream_validate);
+    }
+    try {
+        {
+            io::Writer w(spec.file_name.c_str());
+            spec.generate(rng, w);
+        }
+        if (validate) {
+            validate(spec.file_name.c_str());
+        }
+    } catch (std::exception const& e) {
+        return {spec.file_name, false, e.what()};
+    }
+    return {spec.file_name, true, "OK"};
+}
+
+inline std::vector<Driver::Result> Driver::run() const {
+    Random master(seed);
+    std::vector<std::future<Result>> futures;
+    ThreadPool pool(n_threads);
+    for (Spec const& spec : specs) {
+        Random rng = master.split();
+        futures.push_back(
+            pool.submit([&spec, rng, this]() { return run_one(spec, rng); }));
+    }
+    std::vector<Result> results;
+    for (auto& f : futures) {
+        results.push_back(f.get());
+    }
+    return results;
+}
+
+}  // namespace cplib::gen
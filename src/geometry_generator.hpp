@@ -0,0 +1,246 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+#include "generator.hpp"
+#include "io.hpp"
+
+namespace cplib::gen {
+
+struct Point {
+    long long x, y;
+
+    bool operator==(Point const& other) const {
+        return x == other.x && y == other.y;
+    }
+    bool operator!=(Point const& other) const { return !(*this == other); }
+    bool operator<(Point const& other) const {
+        return x < other.x || (x == other.x && y < other.y);
+    }
+};
+
+// Cross product of b - a and c - a: positive if a, b, c are in
+// counterclockwise order, zero if they are collinear. Exact for any
+// coordinates below 2^62 in absolute value.
+inline __int128 cross(Point const& a, Point const& b, Point const& c) {
+    return static_cast<__int128>(b.x - a.x) * (c.y - a.y) -
+           static_cast<__int128>(b.y - a.y) * (c.x - a.x);
+}
+
+// Writes one point per line.
+inline void write_points(io::Writer& w, std::vector<Point> const& points) {
+    for (Point const& p : points) {
+        w.write_integer(p.x);
+        w.write_space();
+        w.write_integer(p.y);
+        w.write_newline();
+    }
+}
+
+// Sorts vectors by angle in [0, 2pi), exactly.
+inline void sort_by_angle(std::vector<Point>& v) {
+    auto half = [](Point const& p) { return p.y < 0 || (p.y == 0 && p.x < 0); };
+    std::sort(v.begin(), v.end(), [&half](Point const& a, Point const& b) {
+        if (half(a) != half(b)) return half(a) < half(b);
+        return cross({0, 0}, a, b) > 0;
+    });
+}
+
+// n distinct integers in [0, max_value], in increasing order.
+inline std::vector<long long> distinct_sorted(Random& rng, int n,
+                                              long long max_value) {
+    RandomPermutation p(max_value + 1, rng);
+    std::vector<long long> v(n);
+    for (int i = 0; i < n; ++i) v[i] = p[i];
+    std::sort(v.begin(), v.end());
+    return v;
+}
+
+// Valtr's chains: the differences between consecutive values of two random
+// monotone chains from the minimum to the maximum of `v` and back. They are
+// non-zero and sum to zero.
+inline std::vector<long long> valtr_chains(Random& rng,
+                                           std::vector<long long> const& v) {
+    int n = v.size();
+    std::vector<long long> d;
+    d.reserve(n);
+    long long last_up = v[0], last_down = v[0];
+    for (int i = 1; i + 1 < n; ++i) {
+        if (rng() & 1) {
+            d.push_back(v[i] - last_up);
+            last_up = v[i];
+        } else {
+            d.push_back(last_down - v[i]);
+            last_down = v[i];
+        }
+    }
+    d.push_back(v[n - 1] - last_up);
+    d.push_back(last_down - v[n - 1]);
+    return d;
+}
+
+// n points in strictly convex position (no three collinear), with coordinates
+// in [0, max_coordinate], in counterclockwise order.
+//
+// Uses Valtr's algorithm: the edge vectors are obtained by pairing the
+// differences of two random chains of distinct x (y) coordinates, and then
+// sorted by angle. Parallel edge vectors would make the polygon only weakly
+// convex, so in that case the polygon is generated again: this is unlikely,
+// unless the coordinates are barely large enough to fit n points in convex
+// position (roughly, max_coordinate ~ n^1.5 / 10).
+inline std::vector<Point> convex_polygon(Random& rng, int n,
+                                         long long max_coordinate) {
+    if (n < 3) {
+        throw InvalidArgumentException("Polygon must have at least 3 points");
+    }
+    if (max_coordinate < n - 1 || max_coordinate >= (1LL << 61)) {
+        throw InvalidArgumentException("Coordinates must be in [" +
+                                       std::to_string(n - 1) + ", 2^61)");
+    }
+    static constexpr int MAX_ATTEMPTS = 100;
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+        std::vector<long long> xs = distinct_sorted(rng, n, max_coordinate);
+        std::vector<long long> ys = distinct_sorted(rng, n, max_coordinate);
+        std::vector<long long> dx = valtr_chains(rng, xs);
+        std::vector<long long> dy = valtr_chains(rng, ys);
+        rng.shuffle(dy.begin(), dy.end());
+        std::vector<Point> edges(n);
+        for (int i = 0; i < n; ++i) edges[i] = {dx[i], dy[i]};
+        sort_by_angle(edges);
+        bool parallel = false;
+        for (int i = 0; i < n && !parallel; ++i) {
+            Point const& a = edges[i];
+            Point const& b = edges[(i + 1) % n];
+            parallel = cross({0, 0}, a, b) == 0 &&
+                       static_cast<__int128>(a.x) * b.x +
+                               static_cast<__int128>(a.y) * b.y >
+                           0;
+        }
+        if (parallel) continue;
+
+        std::vector<Point> polygon(n);
+        Point p{0, 0}, low{0, 0};
+        for (int i = 0; i < n; ++i) {
+            polygon[i] = p;
+            low.x = std::min(low.x, p.x);
+            low.y = std::min(low.y, p.y);
+            p.x += edges[i].x;
+            p.y += edges[i].y;
+        }
+        for (Point& q : polygon) {
+            q.x += xs[0] - low.x;
+            q.y += ys[0] - low.y;
+        }
+        std::rotate(polygon.begin(), polygon.begin() + rng.next(0, n - 1),
+                    polygon.end());
+        return polygon;
+    }
+    throw InvalidArgumentException(
+        "Coordinates too small for " + std::to_string(n) +
+        " points in convex position");
+}
+
+// Deterministic Miller-Rabin test for 64-bit integers.
+inline bool is_prime(std::uint64_t n) {
+    if (n < 2) return false;
+    for (std::uint64_t p : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+        if (n % p == 0) return n == p;
+    }
+    auto mul = [n](std::uint64_t a, std::uint64_t b) {
+        return static_cast<std::uint64_t>(static_cast<__uint128_t>(a) * b % n);
+    };
+    std::uint64_t d = n - 1;
+    int s = 0;
+    while (d % 2 == 0) {
+        d /= 2;
+        ++s;
+    }
+    for (std::uint64_t a : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+        std::uint64_t x = 1;
+        for (std::uint64_t b = a, e = d; e > 0; e >>= 1, b = mul(b, b)) {
+            if (e & 1) x = mul(x, b);
+        }
+        if (x == 1 || x == n - 1) continue;
+        bool composite = true;
+        for (int r = 1; r < s && composite; ++r) {
+            x = mul(x, x);
+            composite = x != n - 1;
+        }
+        if (composite) return false;
+    }
+    return true;
+}
+
+// n points with no three collinear, with coordinates in [0, max_coordinate],
+// in random order.
+//
+// For the largest prime p <= max_coordinate + 1, the points are
+// (x, a x^2 + b x + c mod p) for n distinct random x and random a != 0, b, c:
+// a line meets a parabola in at most two points modulo p, and three collinear
+// integer points would be collinear modulo p too. The axes are then randomly
+// swapped and reflected.
+inline std::vector<Point> no_three_collinear(Random& rng, int n,
+                                             long long max_coordinate) {
+    if (n < 0 || max_coordinate < 0 || max_coordinate >= (1LL << 61)) {
+        throw InvalidArgumentException("Coordinates must be in [0, 2^61)");
+    }
+    std::uint64_t p = max_coordinate + 1;
+    while (p >= 2 && !is_prime(p)) --p;
+    if (p < static_cast<std::uint64_t>(n) || p < 2) {
+        throw InvalidArgumentException(
+            "Coordinates too small for " + std::to_string(n) +
+            " points with no three collinear");
+    }
+    auto mul = [p](std::uint64_t a, std::uint64_t b) {
+        return static_cast<std::uint64_t>(static_cast<__uint128_t>(a) * b % p);
+    };
+    std::uint64_t a = rng.next<std::uint64_t>(1, p - 1);
+    std::uint64_t b = rng.next<std::uint64_t>(0, p - 1);
+    std::uint64_t c = rng.next<std::uint64_t>(0, p - 1);
+    bool swap = rng() & 1, flip_x = rng() & 1, flip_y = rng() & 1;
+    RandomPermutation xs(p, rng);
+    std::vector<Point> points(n);
+    for (int i = 0; i < n; ++i) {
+        std::uint64_t x = xs[i];
+        std::uint64_t y = (mul(mul(a, x) + b, x) + c) % p;
+        Point q{static_cast<long long>(x), static_cast<long long>(y)};
+        if (flip_x) q.x = max_coordinate - q.x;
+        if (flip_y) q.y = max_coordinate - q.y;
+        if (swap) std::swap(q.x, q.y);
+        points[i] = q;
+    }
+    return points;
+}
+
+// Random simple polygon on n points with no three collinear, with coordinates
+// in [0, max_coordinate], in counterclockwise order.
+//
+// The polygon is star-shaped: the points (see no_three_collinear) are sorted
+// by angle around the lowest one, which is exact and never produces
+// crossings since no two points are collinear with it.
+inline std::vector<Point> simple_polygon(Random& rng, int n,
+                                         long long max_coordinate) {
+    if (n < 3) {
+        throw InvalidArgumentException("Polygon must have at least 3 points");
+    }
+    std::vector<Point> points = no_three_collinear(rng, n, max_coordinate);
+    auto lowest = std::min_element(
+        points.begin(), points.end(), [](Point const& a, Point const& b) {
+            return a.y < b.y || (a.y == b.y && a.x < b.x);
+        });
+    std::iter_swap(points.begin(), lowest);
+    Point o = points[0];
+    std::sort(points.begin() + 1, points.end(),
+              [&o](Point const& a, Point const& b) {
+                  return cross(o, a, b) > 0;
+              });
+    std::rotate(points.begin(), points.begin() + rng.next(0, n - 1),
+                points.end());
+    return points;
+}
+
+}  // namespace cplib::gen
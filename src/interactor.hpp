@@ -0,0 +1,514 @@
+#pragma once
+
+#if __cplusplus < 202002L
+#error "interactor.hpp requires C++20 (coroutines)"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "checker.hpp"
+#include "io.hpp"
+#include "transcript.hpp"
+
+namespace cplib::interact {
+
+// The coroutine type of interactors. An interactor is a function taking a
+// Session& and returning a Task, which suspends itself (with `co_await`) only
+// to wait for input from the solution or to flush its output.
+class Task {
+   public:
+    struct promise_type {
+        std::exception_ptr exception;
+
+        Task get_return_object() {
+            return Task(
+                std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {
+            exception = std::current_exception();
+        }
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Task(Task const&) = delete;
+
+    ~Task() {
+        if (handle) handle.destroy();
+    }
+
+   private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : handle(handle) {}
+
+    friend class Session;
+};
+
+class Engine;
+
+// A single interaction with a solution, through a pair of non-blocking pipes.
+// The reader only sees the data received so far: always wait for it with
+// `co_await session.read_line()` before reading. Likewise, what is written
+// with the writer is only sent by `co_await session.flush()`.
+class Session {
+   private:
+    class InputBuffer : public std::streambuf {
+       private:
+        std::vector<char> data;
+
+       public:
+        void append(const char* s, std::size_t n) {
+            data.erase(data.begin(), data.begin() + (gptr() - eback()));
+            data.insert(data.end(), s, s + n);
+            setg(data.data(), data.data(), data.data() + data.size());
+        }
+        // Whether a non-empty line is available, ignoring the whitespace
+        // (e.g. the newline of the previous line) not consumed yet.
+        bool has_line() const noexcept {
+            const char* p = gptr();
+            while (p < egptr() && chk::is_space(*p)) ++p;
+            return std::memchr(p, '\n', egptr() - p) != nullptr;
+        }
+        std::size_t available() const noexcept { return egptr() - gptr(); }
+    };
+
+    class OutputBuffer : public std::streambuf {
+       private:
+        std::string data;
+        std::size_t sent = 0;
+
+       protected:
+        int_type overflow(int_type c) override {
+            if (c != traits_type::eof()) data.push_back(c);
+            return c;
+        }
+        std::streamsize xsputn(const char* s, std::streamsize n) override {
+            data.append(s, n);
+            return n;
+        }
+
+       public:
+        bool empty() const noexcept { return sent == data.size(); }
+        // Writes as much as possible without blocking. Returns false if the
+        // pipe was closed by the solution.
+        bool send(int fd, io::TranscriptRecorder* recorder,
+                  std::uint32_t stream) {
+            while (sent < data.size()) {
+                ssize_t n = write(fd, data.data() + sent, data.size() - sent);
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    return errno == EAGAIN || errno == EWOULDBLOCK;
+                }
+                if (recorder != nullptr) {
+                    recorder->record(stream, data.data() + sent, n);
+                }
+                sent += n;
+            }
+            data.clear();
+            sent = 0;
+            return true;
+        }
+    };
+
+    // CLOSE: the interactor returned, and its remaining output is being sent
+    // before closing the pipes.
+    enum class Waiting { NOTHING, LINE, FLUSH, CLOSE };
+
+    int read_fd, write_fd;
+    std::uint32_t id;
+    io::TranscriptRecorder* recorder = nullptr;
+    InputBuffer input;
+    OutputBuffer output;
+    std::istream* input_stream;
+    io::Reader reader_;
+    io::Writer writer_;
+
+    bool read_closed = false;
+    bool write_failed = false;
+    Waiting waiting = Waiting::NOTHING;
+    bool finished = false;
+    std::chrono::milliseconds timeout;
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::time_point::max();
+    Task task;
+    chk::Verdict verdict_;
+
+    bool receive();
+    bool send();
+    bool can_resume() const noexcept;
+    void resume();
+    void finish();
+    void drain();
+    void time_out();
+    void fail(std::string const& message);
+    void end();
+
+    friend class Engine;
+
+   public:
+    Session(int read_fd, int write_fd, std::uint32_t id,
+            std::function<Task(Session&)> const& interactor,
+            std::chrono::milliseconds timeout);
+    Session(Session const&) = delete;
+
+    ~Session();
+
+    io::Reader& reader() noexcept { return reader_; }
+    io::Writer& writer() noexcept { return writer_; }
+
+    // Whether the verdict is final and the pipes are closed.
+    bool done() const noexcept { return finished; }
+    chk::Verdict const& verdict() const noexcept { return verdict_; }
+
+    // Awaitable suspending the interactor until a whole line is available to
+    // the reader. Throws io::EOFException if the solution closed its output.
+    auto read_line() {
+        struct Awaiter {
+            Session& s;
+            bool await_ready() const noexcept {
+                return s.input.has_line() || s.read_closed;
+            }
+            void await_suspend(std::coroutine_handle<>) noexcept {
+                s.waiting = Waiting::LINE;
+            }
+            void await_resume() const {
+                s.input_stream->clear();
+                if (s.input.available() == 0) {
+                    throw io::EOFException();
+                }
+            }
+        };
+        return Awaiter{*this};
+    }
+
+    // Awaitable suspending the interactor until all its output has been sent.
+    // Throws io::IOException if the solution closed its input.
+    auto flush() {
+        struct Awaiter {
+            Session& s;
+            bool await_ready() {
+                s.write_failed = !s.send();
+                return s.write_failed || s.output.empty();
+            }
+            void await_suspend(std::coroutine_handle<>) noexcept {
+                s.waiting = Waiting::FLUSH;
+            }
+            void await_resume() const {
+                if (s.write_failed) {
+                    throw io::IOException("Solution closed its input");
+                }
+            }
+        };
+        return Awaiter{*this};
+    }
+};
+
+inline Session::Session(int read_fd, int write_fd, std::uint32_t id,
+                        std::function<Task(Session&)> const& interactor,
+                        std::chrono::milliseconds timeout)
+    : read_fd(read_fd),
+      write_fd(write_fd),
+      id(id),
+      input_stream(new std::istream(&input)),
+      reader_(*input_stream),
+      writer_(*new std::ostream(&output)),
+      timeout(timeout),
+      task(interactor(*this)) {
+    fcntl(read_fd, F_SETFL, fcntl(read_fd, F_GETFL) | O_NONBLOCK);
+    fcntl(write_fd, F_SETFL, fcntl(write_fd, F_GETFL) | O_NONBLOCK);
+}
+
+inline Session::~Session() {
+    if (read_fd >= 0) close(read_fd);
+    if (write_fd >= 0) close(write_fd);
+}
+
+// Reads everything available from the pipe. Returns false on EOF.
+inline bool Session::receive() {
+    char buffer[1 << 16];
+    while (true) {
+        ssize_t n = read(read_fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            if (recorder != nullptr) {
+                recorder->record(id << 1, buffer, n);
+            }
+            input.append(buffer, n);
+        } else if (n == 0) {
+            return false;
+        } else if (errno != EINTR) {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+    }
+}
+
+inline bool Session::send() {
+    return output.send(write_fd, recorder, id << 1 | 1);
+}
+
+inline bool Session::can_resume() const noexcept {
+    switch (waiting) {
+        case Waiting::LINE:
+            return input.has_line() || read_closed;
+        case Waiting::FLUSH:
+            return output.empty() || write_failed;
+        default:
+            return false;
+    }
+}
+
+inline void Session::resume() {
+    waiting = Waiting::NOTHING;
+    task.handle.resume();
+    if (task.handle.done()) {
+        finish();
+    }
+}
+
+// Judges the interactor once it returned. Exceptions other than those blaming
+// the solution give an error verdict.
+inline void Session::finish() {
+    try {
+        verdict_ = chk::judge([this]() {
+            try {
+                if (task.handle.promise().exception) {
+                    std::rethrow_exception(task.handle.promise().exception);
+                }
+            } catch (io::IOException const& e) {
+                throw chk::WrongAnswerException(e.what());
+            } catch (FailedValidationException const& e) {
+                throw chk::WrongAnswerException(e.what());
+            }
+        });
+    } catch (std::exception const& e) {
+        verdict_ = {0.0, e.what(), true};
+    } catch (...) {
+        verdict_ = {0.0, "Unknown exception", true};
+    }
+    waiting = Waiting::CLOSE;
+    drain();
+}
+
+// Sends what the interactor wrote but didn't flush, ending the session once
+// it's all sent. If the solution closes its input first, the output is
+// truncated and the verdict says so.
+inline void Session::drain() {
+    if (!write_failed) {
+        write_failed = !send();
+        if (!write_failed && !output.empty()) {
+            return;
+        }
+        if (write_failed) {
+            verdict_.message +=
+                " (output truncated: solution closed its input)";
+        }
+    }
+    end();
+}
+
+inline void Session::time_out() {
+    if (waiting == Waiting::CLOSE) {
+        verdict_.message += " (output truncated: time limit exceeded)";
+    } else {
+        verdict_ = {0.0, "Time limit exceeded"};
+    }
+    end();
+}
+
+inline void Session::fail(std::string const& message) {
+    verdict_ = {0.0, message, true};
+    end();
+}
+
+inline void Session::end() {
+    if (read_fd >= 0) close(read_fd);
+    if (write_fd >= 0) close(write_fd);
+    read_fd = write_fd = -1;
+    finished = true;
+}
+
+// Runs many sessions in a single thread, resuming each interactor when the
+// data it is waiting for is available. The engine takes ownership of the
+// file descriptors, which are closed at the end of each session.
+// A session failing (an interactor throwing anything but the exceptions
+// blaming the solution) gets an error verdict, without affecting the others.
+// A session with a timeout, counted from the start of run(), gets a zero
+// score once it expires.
+// SIGPIPE is ignored, so that a solution closing its input is reported as an
+// error on flush rather than killing the process.
+//
+// Optionally, the engine records the transcripts of all the sessions: the
+// bytes received from (sent to) the solution of the i-th session are recorded
+// as stream 2i (2i + 1).
+class Engine {
+   private:
+    int epoll_fd;
+    std::vector<std::unique_ptr<Session>> sessions;
+    io::TranscriptRecorder* recorder = nullptr;
+
+    void handle_event(Session& s, bool is_read);
+    void advance(Session& s, bool is_read, bool is_start);
+
+   public:
+    Engine();
+    Engine(Engine const&) = delete;
+
+    ~Engine() { close(epoll_fd); }
+
+    // If positive, `timeout` limits the duration of the session.
+    Session& add(int read_fd, int write_fd,
+                 std::function<Task(Session&)> const& interactor,
+                 std::chrono::milliseconds timeout = {});
+
+    void record_to(io::TranscriptRecorder& recorder);
+
+    void run();
+};
+
+inline Engine::Engine() : epoll_fd(epoll_create1(0)) {
+    if (epoll_fd < 0) {
+        throw io::IOException("Couldn't create epoll instance");
+    }
+    signal(SIGPIPE, SIG_IGN);
+}
+
+inline Session& Engine::add(int read_fd, int write_fd,
+                            std::function<Task(Session&)> const& interactor,
+                            std::chrono::milliseconds timeout) {
+    sessions.push_back(std::make_unique<Session>(
+        read_fd, write_fd, sessions.size(), interactor, timeout));
+    sessions.back()->recorder = recorder;
+    std::uint64_t id = (sessions.size() - 1) << 1;
+    epoll_event read_event{};
+    read_event.events = EPOLLIN;
+    read_event.data.u64 = id;
+    epoll_event write_event{};
+    write_event.events = EPOLLOUT | EPOLLET;
+    write_event.data.u64 = id | 1;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, read_fd, &read_event) < 0 ||
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, write_fd, &write_event) < 0) {
+        throw io::IOException("Couldn't register session: " +
+                              std::string(std::strerror(errno)));
+    }
+    return *sessions.back();
+}
+
+inline void Engine::record_to(io::TranscriptRecorder& recorder) {
+    this->recorder = &recorder;
+    for (auto& s : sessions) {
+        s->recorder = &recorder;
+    }
+}
+
+inline void Engine::handle_event(Session& s, bool is_read) {
+    if (s.done()) {
+        return;
+    }
+    if (is_read && !s.read_closed && !s.receive()) {
+        s.read_closed = true;
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, s.read_fd, nullptr);
+    }
+    if (!is_read && s.waiting == Session::Waiting::CLOSE) {
+        s.drain();
+        return;
+    }
+    if (!is_read && s.waiting == Session::Waiting::FLUSH) {
+        s.write_failed = !s.send();
+    }
+    if (s.can_resume()) {
+        s.resume();
+    }
+}
+
+// Starts the session or handles an event, ending the session with an error
+// verdict if that throws (e.g. when recording the transcript fails).
+inline void Engine::advance(Session& s, bool is_read, bool is_start) {
+    try {
+        if (is_start) {
+            s.resume();
+        } else {
+            handle_event(s, is_read);
+        }
+    } catch (std::exception const& e) {
+        s.fail(e.what());
+    } catch (...) {
+        s.fail("Unknown exception");
+    }
+}
+
+inline void Engine::run() {
+    using std::chrono::steady_clock;
+    std::size_t active = 0;
+    bool has_deadlines = false;
+    auto start = steady_clock::now();
+    for (auto& s : sessions) {
+        if (!s->done()) {
+            if (s->timeout.count() > 0) {
+                s->deadline = start + s->timeout;
+                has_deadlines = true;
+            }
+            advance(*s, false, true);
+            active += !s->done();
+        }
+    }
+    std::vector<epoll_event> events(256);
+    while (active > 0) {
+        // Wake up in time for the earliest deadline.
+        int wait = -1;
+        if (has_deadlines) {
+            auto earliest = steady_clock::time_point::max();
+            for (auto& s : sessions) {
+                if (!s->done()) earliest = std::min(earliest, s->deadline);
+            }
+            if (earliest != steady_clock::time_point::max()) {
+                auto left = std::chrono::ceil<std::chrono::milliseconds>(
+                    earliest - steady_clock::now());
+                wait = std::max<std::int64_t>(left.count(), 0);
+            }
+        }
+        int n = epoll_wait(epoll_fd, events.data(), events.size(), wait);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw io::IOException("epoll_wait failed: " +
+                                  std::string(std::strerror(errno)));
+        }
+        for (int i = 0; i < n; ++i) {
+            Session& s = *sessions[events[i].data.u64 >> 1];
+            bool was_done = s.done();
+            advance(s, (events[i].data.u64 & 1) == 0, false);
+            active -= !was_done && s.done();
+        }
+        if (has_deadlines) {
+            auto now = steady_clock::now();
+            for (auto& s : sessions) {
+                if (!s->done() && s->deadline <= now) {
+                    s->time_out();
+                    --active;
+                }
+            }
+        }
+    }
+}
+
+}  // namespace cplib::interact
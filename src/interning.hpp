@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "common.hpp"
+
+namespace cplib {
+
+// Maps strings to dense ids (0, 1, 2, ... in order of first occurrence), so
+// that checkers and validators can work with integers instead of strings.
+//
+// The strings are copied into a single arena and looked up in a flat
+// open-addressing table of (hash, id), kept at most half full: interning a
+// string hashes its bytes and, in the expected case, compares it once, with no
+// allocation unless the arena or the table grows. clear() keeps the memory,
+// so that an interner can be reused across inputs. Up to 2^32 - 1 strings.
+//
+// The hash is keyed by a random seed by default, so that inputs can't be
+// crafted to collide; a fixed seed makes the probe sequences reproducible.
+class StringInterner {
+   private:
+    struct Slot {
+        // The high half of the hash, to skip most comparisons.
+        std::uint32_t tag;
+        // 1 + the id of the string, or 0 if the slot is empty.
+        std::uint32_t id;
+    };
+
+    std::uint64_t key;
+    std::vector<char> arena;
+    // The string with id i is arena[offsets[i], offsets[i + 1]).
+    std::vector<std::size_t> offsets{0};
+    std::vector<Slot> table;
+    std::size_t max_probe = 0;
+
+    std::uint64_t hash(std::string_view s) const noexcept {
+        return hash_bytes(s.data(), s.size(), key);
+    }
+
+    // Rebuilds the table with n_slots slots (a power of 2).
+    void rehash(std::size_t n_slots);
+
+   public:
+    static constexpr std::size_t npos = -1;
+
+    StringInterner() : StringInterner(random_seed()) {}
+    explicit StringInterner(std::uint64_t seed) : key(mix64(seed)) {}
+
+    // Returns the id of s, interning it if it's new.
+    std::size_t intern(std::string_view s);
+
+    // Returns the id of s, or npos if it was never interned.
+    std::size_t find(std::string_view s) const noexcept;
+
+    // Valid until the next call to intern (which may move the arena).
+    std::string_view get(std::size_t id) const noexcept {
+        return std::string_view(arena.data() + offsets[id],
+                                offsets[id + 1] - offsets[id]);
+    }
+
+    std::size_t size() const noexcept { return offsets.size() - 1; }
+
+    // The most occupied slots skipped by a lookup so far: small (logarithmic
+    // in the size) unless the strings collide.
+    std::size_t max_probe_length() const noexcept { return max_probe; }
+
+    // Makes room for n strings of total length `length`.
+    void reserve(std::size_t n, std::size_t length);
+
+    void clear() noexcept;
+};
+
+#ifndef CPLIB_DECLARATIONS_ONLY
+CPLIB_INLINE void StringInterner::rehash(std::size_t n_slots) {
+    table.assign(n_slots, Slot{0, 0});
+    std::size_t mask = n_slots - 1;
+    for (std::size_t id = 0; id < size(); ++id) {
+        std::uint64_t h = hash(get(id));
+        std::size_t i = h & mask, probe = 0;
+        while (table[i].id != 0) {
+            i = (i + 1) & mask;
+            ++probe;
+        }
+        max_probe = std::max(max_probe, probe);
+        table[i] = {static_cast<std::uint32_t>(h >> 32),
+                    static_cast<std::uint32_t>(id + 1)};
+    }
+}
+
+CPLIB_INLINE std::size_t StringInterner::intern(std::string_view s) {
+    if (2 * (size() + 1) > table.size()) {
+        rehash(std::max<std::size_t>(16, 2 * table.size()));
+    }
+    std::uint64_t h = hash(s);
+    std::uint32_t tag = h >> 32;
+    std::size_t mask = table.size() - 1;
+    std::size_t i = h & mask, probe = 0;
+    for (; table[i].id != 0; i = (i + 1) & mask, ++probe) {
+        if (table[i].tag == tag && get(table[i].id - 1) == s) {
+            max_probe = std::max(max_probe, probe);
+            return table[i].id - 1;
+        }
+    }
+    max_probe = std::max(max_probe, probe);
+    std::size_t id = size();
+    arena.insert(arena.end(), s.begin(), s.end());
+    offsets.push_back(arena.size());
+    table[i] = {tag, static_cast<std::uint32_t>(id + 1)};
+    return id;
+}
+
+CPLIB_INLINE std::size_t StringInterner::find(
+    std::string_view s) const noexcept {
+    if (table.empty()) {
+        return npos;
+    }
+    std::uint64_t h = hash(s);
+    std::uint32_t tag = h >> 32;
+    std::size_t mask = table.size() - 1;
+    for (std::size_t i = h & mask; table[i].id != 0; i = (i + 1) & mask) {
+        if (table[i].tag == tag && get(table[i].id - 1) == s) {
+            return table[i].id - 1;
+        }
+    }
+    return npos;
+}
+
+CPLIB_INLINE void StringInterner::reserve(std::size_t n, std::size_t length) {
+    arena.reserve(length);
+    offsets.reserve(n + 1);
+    std::size_t n_slots = std::max<std::size_t>(16, table.size());
+    while (n_slots < 2 * n) {
+        n_slots *= 2;
+    }
+    if (n_slots > table.size()) {
+        rehash(n_slots);
+    }
+}
+
+CPLIB_INLINE void StringInterner::clear() noexcept {
+    arena.clear();
+    offsets.resize(1);
+    std::fill(table.begin(), table.end(), Slot{0, 0});
+    max_probe = 0;
+}
+#endif
+
+}  // namespace cplib
@@ -1,3 +1,9 @@
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
 #include <cstdio>
 #include <cstring>
 #include <exception>
@@ -9,6 +15,7 @@
 #include <numeric>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 #include "common.hpp"
 
@@ -20,6 +27,9 @@ class IOException : public CplibException {
 
    public:
     IOException(std::string const& msg) : CplibException(msg) {}
+
+   protected:
+    using CplibException::CplibException;
 };
 
 class OpenFailureException : public IOException {
@@ -30,7 +40,7 @@ class OpenFailureException : public IOException {
 
 class EOFException : public IOException {
    public:
-    EOFException() : IOException("Reached EOF") {}
+    EOFException() noexcept : IOException({"Reached EOF"}, {}) {}
 };
 
 class UnexpectedReadException : public IOException {
@@ -40,10 +50,18 @@ class UnexpectedReadException : public IOException {
     }
 
    public:
-    UnexpectedReadException(char c)
-        : IOException("Encountered character '" + std::string(1, c) + "'") {}
+    UnexpectedReadException(char c) noexcept
+        : IOException({"Encountered character '", "'"}, {c}) {}
     UnexpectedReadException(std::string const& s)
         : IOException("Expected " + s) {}
+
+    // Like UnexpectedReadException(s), where `s` is a string literal.
+    static UnexpectedReadException expected(const char* s) noexcept {
+        return UnexpectedReadException({"Expected ", ""}, {s});
+    }
+
+   protected:
+    using IOException::IOException;
 };
 
 class OverflowException : public IOException {
@@ -55,11 +73,81 @@ class OverflowException : public IOException {
    public:
     template <class T>
     explicit OverflowException(T max_integer)
-        : IOException("Exceeded limit " + std::to_string(max_integer)) {}
+        : IOException({"Exceeded limit ", ""}, {max_integer}) {}
 };
 
 class Reader {
    private:
+    // The input bound with rebind: a file descriptor or a view of a string,
+    // read through a buffer which is allocated once and reused for all of
+    // them.
+    class Input : public std::istream {
+       private:
+        class Buffer : public std::streambuf {
+           private:
+            static constexpr std::size_t SIZE = 1 << 16;
+
+            // The first byte keeps the last character of the previous chunk,
+            // so that it can be put back.
+            std::unique_ptr<char[]> data{new char[SIZE + 1]};
+            int fd = -1;
+            bool owned = false;
+
+           protected:
+            int_type underflow() override {
+                if (fd < 0) return traits_type::eof();
+                char* begin = data.get() + 1;
+                if (gptr() > eback()) {
+                    data[0] = gptr()[-1];
+                    begin = data.get();
+                }
+                ssize_t n;
+                do {
+                    n = ::read(fd, data.get() + 1, SIZE);
+                } while (n < 0 && errno == EINTR);
+                if (n <= 0) return traits_type::eof();
+                setg(begin, data.get() + 1, data.get() + 1 + n);
+                return traits_type::to_int_type(data[1]);
+            }
+
+           public:
+            ~Buffer() { close(); }
+
+            void bind(int fd, bool owned) noexcept {
+                close();
+                this->fd = fd;
+                this->owned = owned;
+            }
+            void bind(std::string_view s) noexcept {
+                close();
+                char* p = const_cast<char*>(s.data());
+                setg(p, p, p + s.size());
+            }
+            void close() noexcept {
+                if (owned) ::close(fd);
+                fd = -1;
+                owned = false;
+                setg(nullptr, nullptr, nullptr);
+            }
+        } buffer;
+
+       public:
+        Input() : std::istream(nullptr) { rdbuf(&buffer); }
+
+        void bind(int fd, bool owned) noexcept {
+            buffer.bind(fd, owned);
+            clear();
+        }
+        void bind(std::string_view s) noexcept {
+            buffer.bind(s);
+            clear();
+        }
+        void close() noexcept {
+            buffer.close();
+            clear();
+        }
+    };
+
     std::unique_ptr<std::istream> source;
 
     bool strict = false;
@@ -71,6 +159,9 @@ class Reader {
     }
     static inline bool is_numeric(char c) { return '0' <= c && c <= '9'; }
 
+    // The reusable input, created on first use.
+    Input& input();
+
     template <class T>
     T read_unsigned_strict();
 
@@ -114,6 +205,26 @@ class Reader {
         return *this;
     }
 
+    // Binds the reader to another input, keeping its configuration (strict
+    // mode, leading zeros, decimal separator): a reader can be reused for any
+    // number of inputs, with no allocation after the first one. The previous
+    // input is released as by reset().
+    Reader& rebind(const char* file_name);
+    Reader& rebind(std::string const& file_name) {
+        return rebind(file_name.c_str());
+    }
+    // The file descriptor is not closed by the reader.
+    Reader& rebind(int fd);
+    // Reads the string itself, which is not copied: it must outlive the
+    // reading.
+    Reader& rebind_view(std::string_view s);
+    Reader& rebind_view(std::string&& s) = delete;
+
+    // Releases the input, closing the files opened by the reader: until the
+    // next rebind, the reader is at EOF. The configuration and the buffer of
+    // the reader are kept for a later rebind.
+    Reader& reset();
+
     Reader& make_strict() {
         strict = true;
         return *this;
@@ -145,6 +256,8 @@ class Reader {
     void must_be_newline();
     void must_be_eof();
 
+    bool is_eof() noexcept;
+
     void skip_spaces() noexcept;
     void skip_non_numeric() noexcept;
 
@@ -238,32 +351,72 @@ class Reader {
     }
 };
 
-void Reader::must_be_space() {
+#ifndef CPLIB_DECLARATIONS_ONLY
+CPLIB_INLINE Reader::Input& Reader::input() {
+    auto* input = dynamic_cast<Input*>(source.get());
+    if (input == nullptr) {
+        input = new Input();
+        source.reset(input);
+    }
+    return *input;
+}
+
+CPLIB_INLINE Reader& Reader::rebind(const char* file_name) {
+    Input& in = input();
+    int fd = ::open(file_name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        in.close();
+        throw OpenFailureException(std::string(file_name));
+    }
+    in.bind(fd, true);
+    return *this;
+}
+
+CPLIB_INLINE Reader& Reader::rebind(int fd) {
+    input().bind(fd, false);
+    return *this;
+}
+
+CPLIB_INLINE Reader& Reader::rebind_view(std::string_view s) {
+    input().bind(s);
+    return *this;
+}
+
+CPLIB_INLINE Reader& Reader::reset() {
+    input().close();
+    return *this;
+}
+
+CPLIB_INLINE void Reader::must_be_space() {
     char c = read_char();
     if (c != ' ') {
-        throw UnexpectedReadException("space");
+        throw UnexpectedReadException::expected("space");
     }
 }
 
-void Reader::must_be_newline() {
+CPLIB_INLINE void Reader::must_be_newline() {
     char c = read_char();
     if (c == '\r') {
         c = read_char();
     }
     if (c != '\n') {
-        throw UnexpectedReadException("newline");
+        throw UnexpectedReadException::expected("newline");
     }
 }
 
-void Reader::must_be_eof() {
-    source->peek();
-    if (source->eof()) {
+CPLIB_INLINE void Reader::must_be_eof() {
+    if (is_eof()) {
         return;
     }
-    throw UnexpectedReadException("EOF");
+    throw UnexpectedReadException::expected("EOF");
+}
+
+CPLIB_INLINE bool Reader::is_eof() noexcept {
+    source->peek();
+    return source->eof();
 }
 
-void Reader::skip_spaces() noexcept {
+CPLIB_INLINE void Reader::skip_spaces() noexcept {
     char c;
     try {
         do {
@@ -275,7 +428,7 @@ void Reader::skip_spaces() noexcept {
     source->unget();
 }
 
-void Reader::skip_non_numeric() noexcept {
+CPLIB_INLINE void Reader::skip_non_numeric() noexcept {
     char c;
     try {
         do {
@@ -287,7 +440,7 @@ void Reader::skip_non_numeric() noexcept {
     source->unget();
 };
 
-char Reader::read_char() {
+CPLIB_INLINE char Reader::read_char() {
     char c;
     source->get(c);
     if (source->eof()) {
@@ -296,7 +449,7 @@ char Reader::read_char() {
     return c;
 }
 
-std::string Reader::read_constant(std::string const& token) {
+CPLIB_INLINE std::string Reader::read_constant(std::string const& token) {
     if (token.empty()) {
         throw InvalidArgumentException(
             "Argument 'token' must not be the empty string");
@@ -313,7 +466,8 @@ std::string Reader::read_constant(std::string const& token) {
     return std::string(s);
 }
 
-std::string Reader::read_any_of(std::vector<std::string> const& tokens) {
+CPLIB_INLINE std::string Reader::read_any_of(
+    std::vector<std::string> const& tokens) {
     if (tokens.empty()) {
         throw InvalidArgumentException("Argument 'tokens' must not be empty");
     }
@@ -345,6 +499,8 @@ std::string Reader::read_any_of(std::vector<std::string> const& tokens) {
     return s;
 }
 
+#endif
+
 template <class T>
 T Reader::read_unsigned_strict() {
     T limit = std::numeric_limits<T>::max();
@@ -423,8 +579,8 @@ template <class T>
 T Reader::read_integer(T min_value, T max_value) {
     T n = read_integer<T>();
     if (n < min_value || n > max_value) {
-        throw FailedValidationException::interval_constraint("n", min_value,
-                                                             max_value);
+        throw FailedValidationException::interval_constraint(
+            StaticString("n"), min_value, max_value);
     }
     return n;
 }
@@ -504,6 +660,7 @@ std::vector<T> Reader::read_n(std::size_t n, std::function<T()> read_single,
 
 template <class T>
 std::vector<T> Reader::read_n_integers(std::size_t n, std::string const& sep) {
+    CPLIB_PROFILE_REGION("Reader::read_n_integers");
     return sep.size() == 0
                ? read_n<T>(
                      n, [this]() { return read_integer<T>(); }, sep)
@@ -514,6 +671,7 @@ std::vector<T> Reader::read_n_integers(std::size_t n, std::string const& sep) {
 template <class T>
 std::vector<T> Reader::read_n_integers(std::size_t n, T min_value, T max_value,
                                        std::string const& sep) {
+    CPLIB_PROFILE_REGION("Reader::read_n_integers");
     return sep.size() == 0
                ? read_n<T>(
                      n,
@@ -527,7 +685,8 @@ std::vector<T> Reader::read_n_integers(std::size_t n, T min_value, T max_value,
                          T x = read_integer_strict<T>();
                          if (x < min_value || x > max_value) {
                              throw FailedValidationException::
-                                 interval_constraint("x", min_value, max_value);
+                                 interval_constraint(StaticString("x"),
+                                                     min_value, max_value);
                          }
                          return x;
                      },
@@ -537,6 +696,7 @@ std::vector<T> Reader::read_n_integers(std::size_t n, T min_value, T max_value,
 template <class T>
 std::vector<T> Reader::read_n_floating_point(std::size_t n,
                                              std::string const& sep) {
+    CPLIB_PROFILE_REGION("Reader::read_n_floating_point");
     return sep.size() == 0
                ? read_n<T>(
                      n, [this]() { return read_floating_point<T>(); }, sep)
@@ -545,7 +705,8 @@ std::vector<T> Reader::read_n_floating_point(std::size_t n,
                      sep);
 }
 
-std::string Reader::read_string_strict(
+#ifndef CPLIB_DECLARATIONS_ONLY
+CPLIB_INLINE std::string Reader::read_string_strict(
     std::function<bool(std::size_t, char)> const& check_char,
     std::size_t min_length, std::size_t max_length) {
     std::string s;
@@ -556,14 +717,15 @@ std::string Reader::read_string_strict(
             c = read_char();
             if (is_space(c)) {
                 if (i == 0) {
-                    throw UnexpectedReadException("non-space character");
+                    throw UnexpectedReadException::expected(
+                        "non-space character");
                 }
                 source->unget();
                 break;
             }
             if (i >= max_length) {
                 throw FailedValidationException::interval_constraint(
-                    "len(string)", min_length, max_length);
+                    StaticString("len(string)"), min_length, max_length);
             }
             if (!check_char(i, c)) {
                 throw FailedValidationException(
@@ -579,32 +741,32 @@ std::string Reader::read_string_strict(
     }
     if (s.size() < min_length) {
         throw FailedValidationException::interval_constraint(
-            "len(string)", min_length, max_length);
+            StaticString("len(string)"), min_length, max_length);
     }
     return s;
 }
 
-std::string Reader::read_string(std::size_t exact_length) {
+CPLIB_INLINE std::string Reader::read_string(std::size_t exact_length) {
     return exact_length > 0 ? read_string(exact_length, exact_length)
                             : read_string(0, std::string::npos);
 }
 
-std::string Reader::read_string(std::size_t min_length,
-                                std::size_t max_length) {
+CPLIB_INLINE std::string Reader::read_string(std::size_t min_length,
+                                             std::size_t max_length) {
     return read_string([](std::size_t i, char c) { return true; }, min_length,
                        max_length);
 }
 
-std::string Reader::read_string(std::string const& allowed_chars,
-                                std::size_t exact_length) {
+CPLIB_INLINE std::string Reader::read_string(std::string const& allowed_chars,
+                                             std::size_t exact_length) {
     return exact_length > 0
                ? read_string(allowed_chars, exact_length, exact_length)
                : read_string(allowed_chars, 0, std::string::npos);
 }
 
-std::string Reader::read_string(std::string const& allowed_chars,
-                                std::size_t min_length,
-                                std::size_t max_length) {
+CPLIB_INLINE std::string Reader::read_string(std::string const& allowed_chars,
+                                             std::size_t min_length,
+                                             std::size_t max_length) {
     return read_string(
         [&allowed_chars](std::size_t i, char c) {
             return allowed_chars.find(c) != std::string::npos;
@@ -612,16 +774,16 @@ std::string Reader::read_string(std::string const& allowed_chars,
         min_length, max_length);
 }
 
-std::string Reader::read_string(
+CPLIB_INLINE std::string Reader::read_string(
     std::function<bool(std::size_t, char)> const& check_char,
     std::size_t min_length, std::size_t max_length) {
     if (!strict) skip_spaces();
     return read_string_strict(check_char, min_length, max_length);
 }
 
-std::vector<std::string> Reader::read_n_strings(std::size_t n,
-                                                std::size_t exact_length,
-                                                std::string const& sep) {
+CPLIB_INLINE std::vector<std::string> Reader::read_n_strings(
+    std::size_t n, std::size_t exact_length, std::string const& sep) {
+    CPLIB_PROFILE_REGION("Reader::read_n_strings");
     return sep.size() == 0
                ? read_n<std::string>(
                      n,
@@ -644,6 +806,8 @@ std::vector<std::string> Reader::read_n_strings(std::size_t n,
                      sep);
 }
 
+#endif
+
 template <class T, std::enable_if_t<std::is_same_v<T, char>, bool>>
 char Reader::read() {
     return read_char();
@@ -718,7 +882,7 @@ class Writer {
     }
 
     void write_space();
-    void write_newline(bool with_cr);
+    void write_newline(bool with_cr = false);
 
     void write_char(char c);
 
@@ -766,25 +930,28 @@ class Writer {
     friend Writer& operator<<(Writer& w, T const& x);
 };
 
-void Writer::write_space() { dest->put(' '); }
+#ifndef CPLIB_DECLARATIONS_ONLY
+CPLIB_INLINE void Writer::write_space() { dest->put(' '); }
 
-void Writer::write_newline(bool with_cr = false) {
+CPLIB_INLINE void Writer::write_newline(bool with_cr) {
     if (with_cr) {
         dest->put('\r');
     }
     dest->put('\n');
 }
 
-void Writer::write_char(char c) { dest->put(c); }
+CPLIB_INLINE void Writer::write_char(char c) { dest->put(c); }
 
-void Writer::write_string(const char* s, std::size_t n) {
+CPLIB_INLINE void Writer::write_string(const char* s, std::size_t n) {
     if (n == 0) {
         n = strlen(s);
     }
     dest->write(s, n);
 }
 
-void Writer::write_string(std::string const& s) { *dest << s; }
+CPLIB_INLINE void Writer::write_string(std::string const& s) { *dest << s; }
+
+#endif
 
 template <class T>
 void Writer::write_integer(T x) {
@@ -853,4 +1020,48 @@ Writer& operator<<(Writer& w, T const& x) {
     return w;
 }
 
+// The instantiations for the common types are compiled once in the cplib
+// library (explicit instantiation definitions with CPLIB_IMPLEMENTATION), and
+// only declared elsewhere.
+#ifdef CPLIB_COMPILED
+#ifdef CPLIB_IMPLEMENTATION
+#define CPLIB_INSTANTIATE template
+#else
+#define CPLIB_INSTANTIATE extern template
+#endif
+
+#define CPLIB_INSTANTIATE_INTEGER(T)                               \
+    CPLIB_INSTANTIATE T Reader::read_integer<T>();                 \
+    CPLIB_INSTANTIATE T Reader::read_integer<T>(T, T);             \
+    CPLIB_INSTANTIATE std::vector<T> Reader::read_n_integers<T>(   \
+        std::size_t, std::string const&);                          \
+    CPLIB_INSTANTIATE std::vector<T> Reader::read_n_integers<T>(   \
+        std::size_t, T, T, std::string const&);                    \
+    CPLIB_INSTANTIATE T Reader::read<T>();                         \
+    CPLIB_INSTANTIATE std::vector<T> Reader::read<T>(std::size_t); \
+    CPLIB_INSTANTIATE std::vector<std::vector<T>> Reader::read<T>( \
+        std::size_t, std::size_t);                                 \
+    CPLIB_INSTANTIATE void Writer::write_integer<T>(T);
+
+CPLIB_INSTANTIATE_INTEGER(int)
+CPLIB_INSTANTIATE_INTEGER(long long)
+
+CPLIB_INSTANTIATE double Reader::read_floating_point<double>();
+CPLIB_INSTANTIATE std::vector<double> Reader::read_n_floating_point<double>(
+    std::size_t, std::string const&);
+CPLIB_INSTANTIATE double Reader::read<double>();
+CPLIB_INSTANTIATE std::vector<double> Reader::read<double>(std::size_t);
+CPLIB_INSTANTIATE std::vector<std::vector<double>> Reader::read<double>(
+    std::size_t, std::size_t);
+CPLIB_INSTANTIATE void Writer::write_floating_point<double>(double, int);
+
+CPLIB_INSTANTIATE std::string Reader::read<std::string>();
+CPLIB_INSTANTIATE std::vector<std::string> Reader::read<std::string>(
+    std::size_t);
+CPLIB_INSTANTIATE std::vector<std::vector<std::string>>
+    Reader::read<std::string>(std::size_t, std::size_t);
+
+#undef CPLIB_INSTANTIATE_INTEGER
+#endif
+
 }  // namespace cplib::io
@@ -0,0 +1,504 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "io.hpp"
+#include "stress.hpp"
+#include "thread_pool.hpp"
+
+namespace cplib::stress {
+
+// The layout of a test written by an io::Writer, as a sequence of sections:
+// single lines (e.g. "n m"), arrays on one line, blocks of rows (e.g. edge
+// lists) and matrices. The lengths of arrays, blocks and matrix rows refer to
+// a token of a previous single line, e.g. {0, 1} is the second token of the
+// first section; the number of rows of a block can also be offset from it
+// (e.g. the n - 1 edges of a tree).
+//
+// Columns of a block can be declared as labels (e.g. the endpoints of edges)
+// in a range whose size is given by a token: when an index of the range is
+// removed, so are the rows referring to it, and the larger labels are shifted.
+class Format {
+   public:
+    struct Ref {
+        std::size_t section, token;
+
+        bool operator==(Ref const& other) const {
+            return section == other.section && token == other.token;
+        }
+    };
+
+    enum class Kind { LINE, ARRAY, ROWS };
+
+    struct Section {
+        Kind kind;
+        std::optional<Ref> count, width;
+        long long offset = 0;
+    };
+
+    struct Labels {
+        std::size_t section;
+        std::vector<std::size_t> columns;
+        Ref count;
+        long long base;
+    };
+
+   private:
+    std::vector<Section> sections;
+    std::vector<Labels> labels_;
+
+    std::size_t add(Section section);
+
+   public:
+    std::size_t line() {
+        return add({Kind::LINE, std::nullopt, std::nullopt, 0});
+    }
+    std::size_t array(Ref count) {
+        return add({Kind::ARRAY, count, std::nullopt, 0});
+    }
+    std::size_t rows(Ref count, long long offset = 0) {
+        return add({Kind::ROWS, count, std::nullopt, offset});
+    }
+    std::size_t matrix(Ref rows, Ref columns) {
+        return add({Kind::ROWS, rows, columns, 0});
+    }
+    Format& labels(std::size_t section, std::vector<std::size_t> columns,
+                   Ref count, long long base = 1);
+
+    bool empty() const noexcept { return sections.empty(); }
+    std::vector<Section> const& get_sections() const noexcept {
+        return sections;
+    }
+    std::vector<Labels> const& get_labels() const noexcept { return labels_; }
+};
+
+inline std::size_t Format::add(Section section) {
+    for (std::optional<Ref> ref : {section.count, section.width}) {
+        if (ref && (ref->section >= sections.size() ||
+                    sections[ref->section].kind != Kind::LINE)) {
+            throw InvalidArgumentException(
+                "Lengths must refer to previous single lines");
+        }
+    }
+    sections.push_back(section);
+    return sections.size() - 1;
+}
+
+inline Format& Format::labels(std::size_t section,
+                              std::vector<std::size_t> columns, Ref count,
+                              long long base) {
+    if (section >= sections.size() ||
+        sections[section].kind != Kind::ROWS || count.section >= section ||
+        sections[count.section].kind != Kind::LINE) {
+        throw InvalidArgumentException(
+            "Labels must be columns of a block of rows, counted by a token "
+            "of a previous single line");
+    }
+    labels_.push_back({section, std::move(columns), count, base});
+    return *this;
+}
+
+// Shrinks a failing test found by a Harness, keeping it valid and failing.
+//
+// The test is parsed according to a Format, and reduced as in delta
+// debugging: ranges of indices are removed from each length (from all the
+// arrays, blocks, matrix columns and labels sharing it), halving the size of
+// the ranges down to single indices, and then the remaining numbers are
+// shrunk towards zero. A reduction is kept if the reduced test is accepted by
+// the validator and still fails; the process is repeated until no reduction
+// applies.
+//
+// Reductions leaving the test inconsistent with the format are skipped. With
+// a block whose number of rows is offset from a shared length, this matters:
+// e.g. for a tree given as n and its n - 1 edges, with the vertices declared
+// as labels, only leaves can be removed (removing another vertex removes more
+// than one edge), and without labels n is never reduced.
+//
+// The candidate reductions are tried concurrently, in batches of fixed size,
+// keeping the first successful one of each batch: the result doesn't depend
+// on the number of threads.
+class Minimizer {
+   public:
+    using Validator = std::function<void(io::Reader&)>;
+
+   private:
+    using Line = std::vector<std::string>;
+
+    struct Test {
+        std::vector<std::vector<Line>> sections;
+    };
+
+    struct Reduction {
+        // Either removes [begin, end) from the length `ref`, or sets the
+        // token `ref` of the given line to `value`.
+        bool remove;
+        Format::Ref ref;
+        std::size_t line;
+        std::size_t begin, end;
+        long long value;
+    };
+
+    static constexpr std::size_t BATCH_SIZE = 64;
+
+    Harness const& harness;
+    Format format;
+    Validator validate;
+    std::size_t n_threads = 0;
+
+    Test parse(std::string const& input) const;
+    static std::string to_string(Test const& test);
+
+    static long long value(Test const& test, Format::Ref ref);
+    static std::optional<long long> to_integer(std::string const& token);
+    bool is_structural(std::size_t section, std::size_t line,
+                       std::size_t token) const;
+
+    std::vector<Reduction> reductions(Test const& test) const;
+    bool matches_format(Test const& test) const;
+    std::optional<Test> apply(Test test, Reduction const& reduction) const;
+    // The failure on the test, if it is of the given kind (and the brute
+    // force succeeded): otherwise, the minimization could converge on tests
+    // that only break the brute force, or that make the solution crash
+    // instead of giving a wrong answer.
+    std::optional<Failure> evaluate(Test const& test,
+                                    Failure::Kind kind) const;
+
+   public:
+    Minimizer(Harness const& harness, Format format = Format())
+        : harness(harness), format(std::move(format)) {}
+
+    Minimizer& with_validator(Validator validate) {
+        this->validate = std::move(validate);
+        return *this;
+    }
+    Minimizer& with_threads(std::size_t n_threads) {
+        this->n_threads = n_threads;
+        return *this;
+    }
+
+    // Returns the failure on the minimized test (with the same seed).
+    Failure minimize(Failure const& failure) const;
+};
+
+inline Minimizer::Test Minimizer::parse(std::string const& input) const {
+    std::vector<Line> lines;
+    std::istringstream in(input);
+    for (std::string line; std::getline(in, line);) {
+        std::istringstream tokens(line);
+        lines.emplace_back(std::istream_iterator<std::string>(tokens),
+                           std::istream_iterator<std::string>());
+    }
+    Test test;
+    if (format.empty()) {
+        for (Line& line : lines) test.sections.push_back({std::move(line)});
+        return test;
+    }
+    auto mismatch = [](std::string const& what) {
+        return InvalidArgumentException("Test doesn't match the format: " +
+                                        what);
+    };
+    std::size_t next = 0;
+    for (Format::Section const& section : format.get_sections()) {
+        long long n_lines = section.kind == Format::Kind::ROWS
+                                ? value(test, *section.count) + section.offset
+                                : 1;
+        if (n_lines < 0 ||
+            static_cast<std::size_t>(n_lines) > lines.size() - next) {
+            throw mismatch("not enough lines");
+        }
+        test.sections.emplace_back(lines.begin() + next,
+                                   lines.begin() + next + n_lines);
+        next += n_lines;
+        std::optional<Format::Ref> width =
+            section.kind == Format::Kind::ARRAY ? section.count : section.width;
+        if (width) {
+            long long expected = value(test, *width);
+            for (Line const& line : test.sections.back()) {
+                if (static_cast<long long>(line.size()) != expected) {
+                    throw mismatch("wrong number of tokens in line");
+                }
+            }
+        }
+    }
+    if (next != lines.size()) {
+        throw mismatch("too many lines");
+    }
+    return test;
+}
+
+inline std::string Minimizer::to_string(Test const& test) {
+    std::string s;
+    for (auto const& section : test.sections) {
+        for (Line const& line : section) {
+            for (std::size_t i = 0; i < line.size(); ++i) {
+                if (i > 0) s += ' ';
+                s += line[i];
+            }
+            s += '\n';
+        }
+    }
+    return s;
+}
+
+inline std::optional<long long> Minimizer::to_integer(
+    std::string const& token) {
+    long long x;
+    auto [end, error] =
+        std::from_chars(token.data(), token.data() + token.size(), x);
+    if (error != std::errc() || end != token.data() + token.size()) {
+        return std::nullopt;
+    }
+    return x;
+}
+
+inline long long Minimizer::value(Test const& test, Format::Ref ref) {
+    auto const& section = test.sections[ref.section];
+    if (section.empty() || ref.token >= section[0].size()) {
+        throw InvalidArgumentException("Length refers to a missing token");
+    }
+    std::optional<long long> x = to_integer(section[0][ref.token]);
+    if (!x || *x < 0) {
+        throw InvalidArgumentException("Length must be a non-negative integer");
+    }
+    return *x;
+}
+
+// Whether a token is a length or a label, which are only changed by removals.
+inline bool Minimizer::is_structural(std::size_t section, std::size_t line,
+                                     std::size_t token) const {
+    for (Format::Section const& s : format.get_sections()) {
+        for (std::optional<Format::Ref> ref : {s.count, s.width}) {
+            if (ref && line == 0 && *ref == Format::Ref{section, token}) {
+                return true;
+            }
+        }
+    }
+    for (Format::Labels const& l : format.get_labels()) {
+        if (l.section == section &&
+            std::count(l.columns.begin(), l.columns.end(), token) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline std::vector<Minimizer::Reduction> Minimizer::reductions(
+    Test const& test) const {
+    std::vector<Format::Ref> lengths;
+    auto add_length = [&lengths](std::optional<Format::Ref> ref) {
+        if (ref && std::find(lengths.begin(), lengths.end(), *ref) ==
+                       lengths.end()) {
+            lengths.push_back(*ref);
+        }
+    };
+    for (Format::Section const& s : format.get_sections()) {
+        add_length(s.count);
+        add_length(s.width);
+    }
+    for (Format::Labels const& l : format.get_labels()) {
+        add_length(l.count);
+    }
+
+    std::vector<Reduction> result;
+    for (Format::Ref ref : lengths) {
+        std::size_t n = value(test, ref);
+        for (std::size_t size = n; size > 0; size /= 2) {
+            for (std::size_t begin = 0; begin < n; begin += size) {
+                result.push_back(
+                    {true, ref, 0, begin, std::min(n, begin + size), 0});
+            }
+        }
+    }
+    for (std::size_t s = 0; s < test.sections.size(); ++s) {
+        for (std::size_t i = 0; i < test.sections[s].size(); ++i) {
+            Line const& line = test.sections[s][i];
+            for (std::size_t t = 0; t < line.size(); ++t) {
+                std::optional<long long> x = to_integer(line[t]);
+                if (!x || *x == 0 || is_structural(s, i, t)) continue;
+                long long sign = *x < 0 ? -1 : 1;
+                std::vector<long long> values = {0, sign, *x / 2, *x - sign};
+                std::sort(values.begin(), values.end());
+                values.erase(std::unique(values.begin(), values.end()),
+                             values.end());
+                for (long long y : values) {
+                    if (y != *x) result.push_back({false, {s, t}, i, 0, 0, y});
+                }
+            }
+        }
+    }
+    return result;
+}
+
+// Whether the lengths of the sections match their counts and widths, and the
+// labels are in their ranges.
+inline bool Minimizer::matches_format(Test const& test) const {
+    auto const& sections = format.get_sections();
+    for (std::size_t s = 0; s < sections.size(); ++s) {
+        Format::Section const& section = sections[s];
+        if (section.kind == Format::Kind::ROWS &&
+            static_cast<long long>(test.sections[s].size()) !=
+                value(test, *section.count) + section.offset) {
+            return false;
+        }
+        std::optional<Format::Ref> width =
+            section.kind == Format::Kind::ARRAY ? section.count : section.width;
+        if (!width) continue;
+        long long expected = value(test, *width);
+        for (Line const& line : test.sections[s]) {
+            if (static_cast<long long>(line.size()) != expected) return false;
+        }
+    }
+    for (Format::Labels const& l : format.get_labels()) {
+        long long count = value(test, l.count);
+        for (Line const& row : test.sections[l.section]) {
+            for (std::size_t c : l.columns) {
+                std::optional<long long> x = to_integer(row.at(c));
+                if (x && (*x < l.base || *x >= l.base + count)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+inline std::optional<Minimizer::Test> Minimizer::apply(
+    Test test, Reduction const& r) const {
+    if (!r.remove) {
+        test.sections[r.ref.section][r.line][r.ref.token] =
+            std::to_string(r.value);
+        return test;
+    }
+    auto erase = [&r](auto& v) {
+        if (r.end <= v.size()) {
+            v.erase(v.begin() + r.begin, v.begin() + r.end);
+        }
+    };
+    std::size_t removed = r.end - r.begin;
+    test.sections[r.ref.section][0][r.ref.token] =
+        std::to_string(value(test, r.ref) - removed);
+    // Blocks with an offset aren't indexed by their length: they only shrink
+    // through labels.
+    auto const& sections = format.get_sections();
+    for (std::size_t s = 0; s < sections.size(); ++s) {
+        if (sections[s].count == r.ref && sections[s].offset == 0) {
+            if (sections[s].kind == Format::Kind::ROWS) {
+                erase(test.sections[s]);
+            } else {
+                erase(test.sections[s][0]);
+            }
+        }
+        if (sections[s].width == r.ref) {
+            for (Line& line : test.sections[s]) erase(line);
+        }
+    }
+    for (Format::Labels const& l : format.get_labels()) {
+        if (!(l.count == r.ref)) continue;
+        auto& rows = test.sections[l.section];
+        std::vector<Line> kept;
+        for (Line& row : rows) {
+            bool keep = true;
+            for (std::size_t c : l.columns) {
+                std::optional<long long> x = to_integer(row.at(c));
+                if (!x) continue;
+                long long index = *x - l.base;
+                if (index >= static_cast<long long>(r.begin) &&
+                    index < static_cast<long long>(r.end)) {
+                    keep = false;
+                } else if (index >= static_cast<long long>(r.end)) {
+                    row[c] = std::to_string(*x - removed);
+                }
+            }
+            if (keep) kept.push_back(std::move(row));
+        }
+        rows = std::move(kept);
+        Format::Section const& section = sections[l.section];
+        test.sections[section.count->section][0][section.count->token] =
+            std::to_string(rows.size() - section.offset);
+    }
+    if (!matches_format(test)) {
+        return std::nullopt;
+    }
+    return test;
+}
+
+inline std::optional<Failure> Minimizer::evaluate(Test const& test,
+                                                  Failure::Kind kind) const {
+    std::string input = to_string(test);
+    if (validate) {
+        try {
+            io::Reader r(*new std::istringstream(input), /* strict */ true);
+            validate(r);
+        } catch (std::exception const&) {
+            return std::nullopt;
+        }
+    }
+    std::optional<Failure> failure = harness.test(std::move(input));
+    if (!failure || failure->kind != kind ||
+        kind == Failure::Kind::BRUTE_FORCE_ERROR) {
+        return std::nullopt;
+    }
+    return failure;
+}
+
+inline Failure Minimizer::minimize(Failure const& failure) const {
+    Test best = parse(failure.input);
+    Failure result = failure;
+    ThreadPool pool(n_threads);
+    // After a successful reduction, the next pass resumes from the same
+    // position (i.e. the same length and size of the removed ranges): the
+    // process ends after a whole pass without successes.
+    std::size_t resume = 0;
+    while (true) {
+        std::vector<Reduction> candidates = reductions(best);
+        bool progress = false;
+        for (std::size_t first = std::min(resume, candidates.size());
+             first < candidates.size() && !progress; first += BATCH_SIZE) {
+            std::size_t last = std::min(candidates.size(), first + BATCH_SIZE);
+            std::vector<std::optional<Test>> tests;
+            for (std::size_t i = first; i < last; ++i) {
+                tests.push_back(apply(best, candidates[i]));
+            }
+            std::vector<std::future<std::optional<Failure>>> outcomes;
+            for (std::optional<Test> const& test : tests) {
+                if (!test) {
+                    outcomes.emplace_back();
+                    continue;
+                }
+                outcomes.push_back(pool.submit([this, &test, &failure]() {
+                    return evaluate(*test, failure.kind);
+                }));
+            }
+            // The tasks refer to `tests`: all of them must be over before
+            // an exception from one of them leaves this scope.
+            for (auto& outcome : outcomes) {
+                if (outcome.valid()) outcome.wait();
+            }
+            for (std::size_t i = 0; i < outcomes.size(); ++i) {
+                if (!outcomes[i].valid()) continue;
+                std::optional<Failure> outcome = outcomes[i].get();
+                if (outcome && !progress) {
+                    best = std::move(*tests[i]);
+                    result = std::move(*outcome);
+                    result.seed = failure.seed;
+                    resume = first + i;
+                    progress = true;
+                }
+            }
+        }
+        if (!progress) {
+            if (resume == 0) break;
+            resume = 0;
+        }
+    }
+    return result;
+}
+
+}  // namespace cplib::stress
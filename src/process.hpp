@@ -0,0 +1,319 @@
+#pragma once
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/ptrace.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "io.hpp"
+
+namespace cplib {
+
+struct ProcessOptions {
+    // If positive, the process is killed once it expires.
+    std::chrono::milliseconds timeout{0};
+    // If non-empty, the standard input is redirected from this file.
+    std::string input_file;
+    // If non-negative, the process is pinned to this CPU.
+    int cpu = -1;
+    // If false, the standard output is read but discarded.
+    bool collect_output = true;
+};
+
+struct ProcessResult {
+    // As returned by waitpid.
+    int status = 0;
+    bool timed_out = false;
+    std::string output;
+
+    std::chrono::microseconds wall_time{0};
+    // User plus system time.
+    std::chrono::microseconds cpu_time{0};
+    // Peak resident set size, in bytes.
+    std::size_t peak_memory = 0;
+
+    bool success() const noexcept {
+        return !timed_out && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    std::string describe() const {
+        if (timed_out) {
+            return "Time limit exceeded";
+        }
+        if (WIFSIGNALED(status)) {
+            return "Killed by signal " + std::to_string(WTERMSIG(status)) +
+                   " (" + strsignal(WTERMSIG(status)) + ")";
+        }
+        return "Exited with status " + std::to_string(WEXITSTATUS(status));
+    }
+};
+
+// The peak resident set size of a live process, in bytes (0 if unknown).
+inline std::size_t peak_memory_of(pid_t pid) {
+    std::string path = "/proc/" + std::to_string(pid) + "/status";
+    FILE* f = std::fopen(path.c_str(), "r");
+    if (f == nullptr) {
+        return 0;
+    }
+    char line[256];
+    std::size_t kib = 0;
+    while (std::fgets(line, sizeof(line), f) != nullptr &&
+           std::sscanf(line, "VmHWM: %zu kB", &kib) != 1) {
+    }
+    std::fclose(f);
+    return kib * 1024;
+}
+
+// Runs `command` (searched in PATH if it has no slash) with `input` on its
+// standard input, collecting its standard output through a pipe; its standard
+// error is discarded. The CPU time of the process is measured with wait4.
+//
+// Its peak memory can't be: a child inherits the peak resident set size of
+// the process it was forked from, which would be the caller's. Instead the
+// child is traced (ptrace), only to stop it when it exits and read its own
+// peak while its memory is still mapped. If tracing isn't allowed, the peak
+// falls back to the one reported by wait4.
+//
+// Safe to call from many threads at once: the pipes are close-on-exec, so
+// that each child only inherits its own. SIGPIPE is ignored in the calling
+// process (a child closing its input early isn't an error of the caller), but
+// restored to the default in the child. The calling thread traces the child,
+// while another thread moves its input and output.
+inline ProcessResult run_process(std::vector<std::string> const& command,
+                                 std::string_view input,
+                                 ProcessOptions const& options) {
+    if (command.empty()) {
+        throw InvalidArgumentException("Empty command");
+    }
+    signal(SIGPIPE, SIG_IGN);
+    bool from_file = !options.input_file.empty();
+    int in[2] = {-1, -1}, out[2];
+    if (!from_file && pipe2(in, O_CLOEXEC) < 0) {
+        throw io::IOException("Couldn't create pipe");
+    }
+    if (pipe2(out, O_CLOEXEC) < 0) {
+        if (!from_file) {
+            close(in[0]);
+            close(in[1]);
+        }
+        throw io::IOException("Couldn't create pipe");
+    }
+
+    std::vector<char*> argv;
+    for (std::string const& arg : command) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    const char* input_file = options.input_file.c_str();
+    int cpu = options.cpu;
+
+    // The child shares the memory of the caller until it calls exec: all
+    // signals are blocked meanwhile, so that no handler runs in it, and it
+    // reports its errors through `error`.
+    sigset_t all_signals, mask;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_SETMASK, &all_signals, &mask);
+    auto start = std::chrono::steady_clock::now();
+    volatile int error = 0;
+    pid_t pid = vfork();
+    if (pid == 0) {
+        auto redirect = [](int fd, int target) {
+            return fd == target ? fcntl(fd, F_SETFD, 0) : dup2(fd, target);
+        };
+        int input_fd = from_file ? open(input_file, O_RDONLY) : in[0];
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (input_fd < 0 || null_fd < 0 || redirect(input_fd, 0) < 0 ||
+            redirect(out[1], 1) < 0 || redirect(null_fd, 2) < 0) {
+            error = errno;
+            _exit(127);
+        }
+        if (cpu >= 0) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu, &cpus);
+            sched_setaffinity(0, sizeof(cpus), &cpus);
+        }
+        signal(SIGPIPE, SIG_DFL);
+        sigprocmask(SIG_SETMASK, &mask, nullptr);
+        ptrace(PTRACE_TRACEME, 0, nullptr, nullptr);
+        execvp(argv[0], argv.data());
+        error = errno;
+        _exit(127);
+    }
+    int spawn_error = pid < 0 ? errno : error;
+    pthread_sigmask(SIG_SETMASK, &mask, nullptr);
+    if (!from_file) close(in[0]);
+    close(out[1]);
+    if (spawn_error != 0) {
+        if (pid > 0) {
+            while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {
+            }
+        }
+        if (!from_file) close(in[1]);
+        close(out[0]);
+        throw io::IOException("Couldn't run " + command[0] + ": " +
+                              std::strerror(spawn_error));
+    }
+
+    auto timeout = options.timeout;
+    auto deadline = start + timeout;
+    ProcessResult result;
+    // The child is only killed before it's reaped, so that its pid can't
+    // have been reused.
+    std::mutex mutex;
+    std::condition_variable exited_cv;
+    bool exited = false;
+    auto kill_child = [&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!exited) kill(pid, SIGKILL);
+    };
+
+    std::thread io_thread([&]() {
+        std::size_t written = 0;
+        int write_fd = in[1];
+        if (!from_file) {
+            fcntl(write_fd, F_SETFL, O_NONBLOCK);
+        }
+        if (write_fd >= 0 && input.empty()) {
+            close(write_fd);
+            write_fd = -1;
+        }
+        char buffer[1 << 16];
+        while (true) {
+            pollfd fds[2] = {{out[0], POLLIN, 0}, {write_fd, POLLOUT, 0}};
+            int wait = -1;
+            if (timeout.count() > 0) {
+                auto left =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline - std::chrono::steady_clock::now());
+                if (left.count() <= 0) {
+                    result.timed_out = true;
+                    kill_child();
+                    break;
+                }
+                wait = left.count();
+            }
+            if (poll(fds, write_fd >= 0 ? 2 : 1, wait) < 0) {
+                if (errno == EINTR) continue;
+                kill_child();
+                break;
+            }
+            if (fds[1].revents != 0) {
+                ssize_t n = write(write_fd, input.data() + written,
+                                  input.size() - written);
+                if (n > 0) written += n;
+                if ((n < 0 && errno != EAGAIN && errno != EINTR) ||
+                    written == input.size()) {
+                    close(write_fd);
+                    write_fd = -1;
+                }
+            }
+            if (fds[0].revents != 0) {
+                ssize_t n = read(out[0], buffer, sizeof(buffer));
+                if (n > 0) {
+                    if (options.collect_output) {
+                        result.output.append(buffer, n);
+                    }
+                } else if (n == 0 || errno != EINTR) {
+                    break;
+                }
+            }
+        }
+        if (write_fd >= 0) close(write_fd);
+        close(out[0]);
+        // The process may outlive its output (e.g. by closing it): the
+        // deadline still holds.
+        std::unique_lock<std::mutex> lock(mutex);
+        if (timeout.count() > 0 && !result.timed_out &&
+            !exited_cv.wait_until(lock, deadline, [&]() { return exited; })) {
+            result.timed_out = true;
+            kill(pid, SIGKILL);
+        }
+    });
+
+    rusage usage{};
+    bool traced = false;
+    std::size_t peak_memory = 0;
+    while (true) {
+        siginfo_t info{};
+        if (waitid(P_PID, pid, &info, WEXITED | WSTOPPED | WNOWAIT) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (info.si_code == CLD_EXITED || info.si_code == CLD_KILLED ||
+            info.si_code == CLD_DUMPED) {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (wait4(pid, &result.status, 0, &usage) < 0 &&
+                   errno == EINTR) {
+            }
+            exited = true;
+            break;
+        }
+        int status;
+        if (waitpid(pid, &status, 0) < 0 || !WIFSTOPPED(status)) {
+            continue;
+        }
+        int forwarded = WSTOPSIG(status);
+        int event = status >> 16;
+        if (!traced) {
+            // Stopped by the exec.
+            traced = true;
+            ptrace(PTRACE_SETOPTIONS, pid, nullptr,
+                   PTRACE_O_TRACEEXIT | PTRACE_O_TRACEEXEC |
+                       PTRACE_O_EXITKILL);
+            if (forwarded == SIGTRAP) forwarded = 0;
+        } else if (event == PTRACE_EVENT_EXIT) {
+            peak_memory = peak_memory_of(pid);
+            forwarded = 0;
+        } else if (event != 0) {
+            forwarded = 0;
+        } else if (forwarded == SIGSTOP || forwarded == SIGTSTP ||
+                   forwarded == SIGTTIN || forwarded == SIGTTOU) {
+            // A group stop, rather than the delivery of a signal, has no
+            // signal info: it's resumed rather than left stopped.
+            siginfo_t signal_info;
+            if (ptrace(PTRACE_GETSIGINFO, pid, nullptr, &signal_info) < 0) {
+                forwarded = 0;
+            }
+        }
+        ptrace(PTRACE_CONT, pid, nullptr, forwarded);
+    }
+    exited_cv.notify_all();
+    io_thread.join();
+
+    result.wall_time = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    result.cpu_time = std::chrono::seconds(usage.ru_utime.tv_sec +
+                                           usage.ru_stime.tv_sec) +
+                      std::chrono::microseconds(usage.ru_utime.tv_usec +
+                                                usage.ru_stime.tv_usec);
+    result.peak_memory =
+        peak_memory > 0 ? peak_memory
+                        : static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+    return result;
+}
+
+inline ProcessResult run_process(
+    std::vector<std::string> const& command, std::string_view input,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) {
+    ProcessOptions options;
+    options.timeout = timeout;
+    return run_process(command, input, options);
+}
+
+}  // namespace cplib
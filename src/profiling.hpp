@@ -0,0 +1,250 @@
+#pragma once
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace cplib::prof {
+
+enum Counter { CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, N_COUNTERS };
+
+// Snapshot of the hardware counters of the calling thread.
+struct Sample {
+    std::uint64_t values[N_COUNTERS] = {};
+    std::uint64_t time_enabled = 0, time_running = 0;
+    std::chrono::steady_clock::time_point time;
+};
+
+// The hardware counters of a thread, opened with perf_event_open as a single
+// group (so that they are scheduled together and read with one syscall),
+// counting in user space only.
+//
+// A counter that can't be opened (no PMU, as in most virtual machines, or
+// perf_event_paranoid too high) is just unavailable: the regions still
+// measure their calls and wall time.
+class CounterGroup {
+   private:
+    int fds[N_COUNTERS];
+    // Position of each counter in the group, or -1 if unavailable.
+    int index[N_COUNTERS];
+    int size = 0;
+    int leader = -1;
+
+   public:
+    CounterGroup();
+    ~CounterGroup();
+    CounterGroup(CounterGroup const&) = delete;
+    CounterGroup& operator=(CounterGroup const&) = delete;
+
+    bool available(Counter c) const noexcept { return index[c] >= 0; }
+
+    Sample read() const noexcept;
+
+    // The group of the calling thread, opened on first use.
+    static CounterGroup& of_this_thread() {
+        static thread_local CounterGroup group;
+        return group;
+    }
+};
+
+inline CounterGroup::CounterGroup() {
+    static constexpr std::uint64_t CONFIGS[N_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int c = 0; c < N_COUNTERS; ++c) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = CONFIGS[c];
+        attr.disabled = leader < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP |
+                           PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fds[c] = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+        index[c] = fds[c] >= 0 ? size++ : -1;
+        if (leader < 0) leader = fds[c];
+    }
+    if (leader >= 0) {
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+inline CounterGroup::~CounterGroup() {
+    for (int c = N_COUNTERS - 1; c >= 0; --c) {
+        if (fds[c] >= 0) close(fds[c]);
+    }
+}
+
+inline Sample CounterGroup::read() const noexcept {
+    Sample sample;
+    sample.time = std::chrono::steady_clock::now();
+    if (size == 0) return sample;
+    // nr, time_enabled, time_running, then a value per counter.
+    std::uint64_t buffer[3 + N_COUNTERS];
+    if (::read(leader, buffer, sizeof(buffer)) < 0) return sample;
+    sample.time_enabled = buffer[1];
+    sample.time_running = buffer[2];
+    for (int c = 0; c < N_COUNTERS; ++c) {
+        if (index[c] >= 0) sample.values[c] = buffer[3 + index[c]];
+    }
+    return sample;
+}
+
+struct Stats {
+    std::uint64_t calls = 0;
+    std::chrono::nanoseconds time{0};
+    // Scaled by the fraction of time the group was actually counting, in case
+    // it was multiplexed with other events.
+    double counters[N_COUNTERS] = {};
+    bool counted[N_COUNTERS] = {};
+
+    void add(Sample const& start, Sample const& end,
+             CounterGroup const& group) noexcept;
+};
+
+inline void Stats::add(Sample const& start, Sample const& end,
+                       CounterGroup const& group) noexcept {
+    ++calls;
+    time += end.time - start.time;
+    std::uint64_t enabled = end.time_enabled - start.time_enabled;
+    std::uint64_t running = end.time_running - start.time_running;
+    double scale = running > 0 ? static_cast<double>(enabled) / running : 1;
+    for (int c = 0; c < N_COUNTERS; ++c) {
+        if (!group.available(static_cast<Counter>(c))) continue;
+        counters[c] += (end.values[c] - start.values[c]) * scale;
+        counted[c] = true;
+    }
+}
+
+// Statistics of all the regions, aggregated over all threads and printed to
+// standard error at exit.
+class Profile {
+   private:
+    mutable std::mutex mutex;
+    std::map<std::string, Stats, std::less<>> regions;
+
+   public:
+    Profile() = default;
+    ~Profile();
+
+    void add(std::string_view region, Sample const& start, Sample const& end,
+             CounterGroup const& group);
+
+    std::map<std::string, Stats, std::less<>> get() const;
+    void clear();
+
+    // Writes a table with a line per region: calls, total wall time, total
+    // counters, and instructions per cycle. Counters inclusive of nested
+    // regions.
+    void write(std::ostream& out) const;
+
+    static Profile& global() {
+        static Profile profile;
+        return profile;
+    }
+};
+
+inline Profile::~Profile() {
+    if (!regions.empty()) write(std::cerr);
+}
+
+inline void Profile::add(std::string_view region, Sample const& start,
+                         Sample const& end, CounterGroup const& group) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = regions.find(region);
+    if (it == regions.end()) {
+        it = regions.emplace(std::string(region), Stats()).first;
+    }
+    it->second.add(start, end, group);
+}
+
+inline std::map<std::string, Stats, std::less<>> Profile::get() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return regions;
+}
+
+inline void Profile::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    regions.clear();
+}
+
+inline void Profile::write(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t width = 6;
+    for (auto const& [name, stats] : regions) {
+        width = std::max(width, name.size());
+    }
+    auto counter = [&out](Stats const& stats, Counter c) {
+        out << ' ' << std::setw(14);
+        if (stats.counted[c]) {
+            out << static_cast<std::uint64_t>(stats.counters[c]);
+        } else {
+            out << '-';
+        }
+    };
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::left << std::setw(width) << "region" << std::right
+        << std::setw(10) << "calls" << std::setw(12) << "time_ms"
+        << std::setw(15) << "cycles" << std::setw(15) << "instructions"
+        << std::setw(6) << "ipc" << std::setw(15) << "cache_misses"
+        << std::setw(15) << "branch_misses" << '\n';
+    for (auto const& [name, stats] : regions) {
+        out << std::left << std::setw(width) << name << std::right << ' '
+            << std::setw(9) << stats.calls << ' ' << std::setw(11)
+            << std::fixed << std::setprecision(3) << stats.time.count() / 1e6;
+        counter(stats, CYCLES);
+        counter(stats, INSTRUCTIONS);
+        out << ' ' << std::setw(5);
+        if (stats.counted[CYCLES] && stats.counted[INSTRUCTIONS] &&
+            stats.counters[CYCLES] > 0) {
+            out << std::setprecision(2)
+                << stats.counters[INSTRUCTIONS] / stats.counters[CYCLES];
+        } else {
+            out << '-';
+        }
+        counter(stats, CACHE_MISSES);
+        counter(stats, BRANCH_MISSES);
+        out << '\n';
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// Measures the enclosing scope as an instance of the named region. The
+// counters are read with one syscall at each end, so regions are meant to be
+// coarse (reading a whole line, checking a whole array), not per element.
+class Region {
+   private:
+    std::string_view name;
+    CounterGroup const& group;
+    Sample start;
+
+   public:
+    explicit Region(std::string_view name)
+        : name(name),
+          group(CounterGroup::of_this_thread()),
+          start(group.read()) {}
+    ~Region() { Profile::global().add(name, start, group.read(), group); }
+
+    Region(Region const&) = delete;
+    Region& operator=(Region const&) = delete;
+};
+
+}  // namespace cplib::prof
@@ -0,0 +1,269 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "io.hpp"
+
+namespace cplib::prof {
+
+// The time stamp counter on x86 (invariant on any recent CPU), nanoseconds of
+// std::chrono::steady_clock elsewhere.
+class TickClock {
+   private:
+    struct Calibration {
+        std::uint64_t ticks;
+        std::chrono::steady_clock::time_point time;
+    };
+
+   public:
+    static std::uint64_t now() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+#endif
+    }
+
+    // The point from which the clock is calibrated against steady_clock: the
+    // first call.
+    static Calibration const& start() {
+        static const Calibration start{now(), std::chrono::steady_clock::now()};
+        return start;
+    }
+
+    // Waits until at least 10ms have passed since the start, if needed.
+    static double ticks_per_second();
+};
+
+inline double TickClock::ticks_per_second() {
+#if defined(__x86_64__) || defined(__i386__)
+    std::chrono::duration<double> elapsed;
+    std::uint64_t ticks;
+    do {
+        ticks = now();
+        elapsed = std::chrono::steady_clock::now() - start().time;
+    } while (elapsed < std::chrono::milliseconds(10));
+    return (ticks - start().ticks) / elapsed.count();
+#else
+    return 1e9;
+#endif
+}
+
+struct TimerNode {
+    const char* name;
+    std::size_t parent;
+    std::uint64_t calls = 0, ticks = 0;
+    std::vector<std::size_t> children;
+};
+
+// The timers of a thread, as a tree of phases: the children of a phase are
+// the phases timed while it was running.
+class TimerTree {
+   private:
+    // The root, with index 0, is never timed.
+    std::vector<TimerNode> nodes{{"", 0, 0, 0, {}}};
+    std::size_t current = 0;
+
+   public:
+    TimerTree();
+    ~TimerTree();
+
+    // Starts timing the phase `name` as a child of the current one, and
+    // makes it the current one.
+    std::size_t enter(const char* name) {
+        for (std::size_t child : nodes[current].children) {
+            if (nodes[child].name == name ||
+                std::strcmp(nodes[child].name, name) == 0) {
+                return current = child;
+            }
+        }
+        nodes.push_back({name, current, 0, 0, {}});
+        nodes[current].children.push_back(nodes.size() - 1);
+        return current = nodes.size() - 1;
+    }
+
+    void exit(std::size_t node, std::uint64_t ticks) noexcept {
+        ++nodes[node].calls;
+        nodes[node].ticks += ticks;
+        current = nodes[node].parent;
+    }
+
+    std::vector<TimerNode> const& get() const noexcept { return nodes; }
+
+    void clear() {
+        nodes.resize(1);
+        nodes[0].children.clear();
+        current = 0;
+    }
+
+    static TimerTree& of_this_thread() {
+        static thread_local TimerTree tree;
+        return tree;
+    }
+};
+
+// The trees of the running threads, and those of the threads that exited.
+struct TimerRegistry {
+    std::mutex mutex;
+    std::vector<TimerTree*> live;
+    std::vector<std::vector<TimerNode>> finished;
+
+    static TimerRegistry& global() {
+        static TimerRegistry registry;
+        return registry;
+    }
+};
+
+inline TimerTree::TimerTree() {
+    TickClock::start();
+    TimerRegistry& registry = TimerRegistry::global();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.live.push_back(this);
+}
+
+inline TimerTree::~TimerTree() {
+    TimerRegistry& registry = TimerRegistry::global();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.live.erase(
+        std::find(registry.live.begin(), registry.live.end(), this));
+    if (nodes.size() > 1) {
+        registry.finished.push_back(std::move(nodes));
+    }
+}
+
+// Times the enclosing scope as an instance of the phase `name`, nested in the
+// phase being timed by the same thread, if any. `name` must outlive the
+// program's timers (typically, it is a string literal).
+//
+// Recording a phase takes a couple of reads of the time stamp counter and a
+// scan of the children of the current phase, with no locking or allocation
+// after the first time: cheap enough to keep the timers in production code.
+class ScopedTimer {
+   private:
+    TimerTree& tree;
+    std::size_t node;
+    std::uint64_t start;
+
+   public:
+    explicit ScopedTimer(const char* name)
+        : tree(TimerTree::of_this_thread()),
+          node(tree.enter(name)),
+          start(TickClock::now()) {}
+    ~ScopedTimer() { tree.exit(node, TickClock::now() - start); }
+
+    ScopedTimer(ScopedTimer const&) = delete;
+    ScopedTimer& operator=(ScopedTimer const&) = delete;
+};
+
+// Timings of a phase, aggregated over all threads, with those of its nested
+// phases. Times are in seconds; the self time excludes the nested phases.
+struct TimerReport {
+    std::string name;
+    std::uint64_t calls = 0;
+    double total = 0, self = 0;
+    std::vector<TimerReport> children;
+
+    // Collects the timers of all threads, as children of an unnamed root.
+    // Must be called when the other threads aren't timing anything (e.g.
+    // after joining them), otherwise their phases could be read while being
+    // updated.
+    static TimerReport collect();
+
+    // Clears the timers of the calling thread and of the exited ones.
+    static void reset();
+
+    TimerReport const* child(std::string_view name) const;
+
+    // Writes a line per phase, indented by nesting, with its calls, total and
+    // self time (in milliseconds).
+    void write(io::Writer& w) const;
+
+   private:
+    void add(std::vector<TimerNode> const& nodes, std::size_t node,
+             double tick);
+    void write(io::Writer& w, std::size_t depth) const;
+};
+
+inline void TimerReport::add(std::vector<TimerNode> const& nodes,
+                             std::size_t node, double tick) {
+    calls += nodes[node].calls;
+    total += nodes[node].ticks * tick;
+    self += nodes[node].ticks * tick;
+    for (std::size_t c : nodes[node].children) {
+        self -= nodes[c].ticks * tick;
+        auto it = std::find_if(
+            children.begin(), children.end(),
+            [&](TimerReport const& r) { return r.name == nodes[c].name; });
+        if (it == children.end()) {
+            children.push_back({nodes[c].name, 0, 0, 0, {}});
+            it = std::prev(children.end());
+        }
+        it->add(nodes, c, tick);
+    }
+}
+
+inline TimerReport TimerReport::collect() {
+    double tick = 1 / TickClock::ticks_per_second();
+    TimerReport report;
+    TimerRegistry& registry = TimerRegistry::global();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (TimerTree const* tree : registry.live) {
+        report.add(tree->get(), 0, tick);
+    }
+    for (std::vector<TimerNode> const& nodes : registry.finished) {
+        report.add(nodes, 0, tick);
+    }
+    report.total = report.self = 0;
+    for (TimerReport const& child : report.children) {
+        report.total += child.total;
+    }
+    return report;
+}
+
+inline void TimerReport::reset() {
+    TimerTree::of_this_thread().clear();
+    TimerRegistry& registry = TimerRegistry::global();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.finished.clear();
+}
+
+inline TimerReport const* TimerReport::child(std::string_view name) const {
+    for (TimerReport const& c : children) {
+        if (c.name == name) return &c;
+    }
+    return nullptr;
+}
+
+inline void TimerReport::write(io::Writer& w) const {
+    for (TimerReport const& c : children) {
+        c.write(w, 0);
+    }
+}
+
+inline void TimerReport::write(io::Writer& w, std::size_t depth) const {
+    w.write_string(std::string(2 * depth, ' ') + name + " calls ");
+    w.write_integer(calls);
+    w.write_string(" total_ms ");
+    w.write_floating_point(total * 1e3, 3);
+    w.write_string(" self_ms ");
+    w.write_floating_point(self * 1e3, 3);
+    w.write_newline();
+    for (TimerReport const& c : children) {
+        c.write(w, depth + 1);
+    }
+}
+
+}  // namespace cplib::prof
@@ -0,0 +1,305 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "io.hpp"
+
+namespace cplib::io {
+
+template <class T>
+class ColumnView {
+   private:
+    const T* ptr = nullptr;
+    std::size_t n = 0;
+
+   public:
+    ColumnView() = default;
+    ColumnView(const T* ptr, std::size_t n) : ptr(ptr), n(n) {}
+
+    const T* begin() const noexcept { return ptr; }
+    const T* end() const noexcept { return ptr + n; }
+    const T* data() const noexcept { return ptr; }
+    std::size_t size() const noexcept { return n; }
+
+    T const& operator[](std::size_t i) const noexcept { return ptr[i]; }
+};
+
+// The parsed content of an input file, as a list of typed columns (arrays of
+// integers, floating point numbers or characters). The columns are stored
+// either in memory owned by the object, or in a read-only shared memory
+// segment published by another process (see load_shared below).
+//
+// Segments are only readable by their owner, and only segments owned by the
+// effective user are attached: another user can't read the tests, nor plant
+// a segment with forged content.
+class ColumnarInput {
+   private:
+    struct Column {
+        std::uint32_t type;
+        std::size_t count;
+        const void* data;
+    };
+
+    struct SegmentHeader {
+        std::uint64_t magic;
+        std::uint64_t hash;
+        std::uint64_t size;
+        std::uint64_t n_columns;
+        std::atomic<std::uint32_t> ready;
+    };
+
+    struct SegmentColumn {
+        std::uint32_t type;
+        std::uint32_t element_size;
+        std::uint64_t count;
+        std::uint64_t offset;
+    };
+
+    static constexpr std::uint64_t MAGIC = 0x6d68'7362'696c'7063ULL;
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    std::vector<Column> columns;
+    // Aligned for any column type.
+    std::vector<std::unique_ptr<std::max_align_t[]>> owned;
+    std::shared_ptr<void> mapping;
+
+    template <class T>
+    static constexpr std::uint32_t type_tag() {
+        return (std::uint32_t(std::is_floating_point_v<T>) << 16) |
+               (std::uint32_t(std::is_signed_v<T>) << 8) | sizeof(T);
+    }
+
+    static std::size_t align(std::size_t n) {
+        return (n + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    Column const& column(std::size_t index, std::uint32_t type) const;
+
+    ColumnarInput& add(std::uint32_t type, const void* data,
+                       std::size_t count, std::size_t element_size);
+
+   public:
+    ColumnarInput() = default;
+    ColumnarInput(ColumnarInput&&) = default;
+    ColumnarInput& operator=(ColumnarInput&&) = default;
+
+    template <class T>
+    ColumnarInput& add(std::vector<T> const& v) {
+        static_assert(std::is_arithmetic_v<T>, "Type must be arithmetic");
+        return add(type_tag<T>(), v.data(), v.size(), sizeof(T));
+    }
+    ColumnarInput& add(std::string const& s) {
+        return add(type_tag<char>(), s.data(), s.size(), 1);
+    }
+    template <class T>
+    ColumnarInput& add_scalar(T x) {
+        static_assert(std::is_arithmetic_v<T>, "Type must be arithmetic");
+        return add(type_tag<T>(), &x, 1, sizeof(T));
+    }
+
+    std::size_t size() const noexcept { return columns.size(); }
+    bool is_shared() const noexcept { return mapping != nullptr; }
+
+    template <class T>
+    ColumnView<T> get(std::size_t index) const {
+        Column const& c = column(index, type_tag<T>());
+        return ColumnView<T>(static_cast<const T*>(c.data), c.count);
+    }
+    template <class T>
+    T get_scalar(std::size_t index) const {
+        return get<T>(index)[0];
+    }
+
+    bool publish(std::string const& name, std::uint64_t hash) const;
+    static bool attach(std::string const& name, std::uint64_t hash,
+                       ColumnarInput& result);
+};
+
+inline ColumnarInput::Column const& ColumnarInput::column(
+    std::size_t index, std::uint32_t type) const {
+    if (index >= columns.size()) {
+        throw InvalidArgumentException("Column " + std::to_string(index) +
+                                       " does not exist");
+    }
+    if (columns[index].type != type) {
+        throw InvalidArgumentException("Column " + std::to_string(index) +
+                                       " has a different type");
+    }
+    return columns[index];
+}
+
+inline ColumnarInput& ColumnarInput::add(std::uint32_t type, const void* data,
+                                         std::size_t count,
+                                         std::size_t element_size) {
+    if (is_shared()) {
+        throw InvalidArgumentException(
+            "Cannot add columns to a shared input");
+    }
+    std::size_t bytes = count * element_size;
+    owned.emplace_back(
+        new std::max_align_t[bytes / sizeof(std::max_align_t) + 1]);
+    std::memcpy(owned.back().get(), data, bytes);
+    columns.push_back({type, count, owned.back().get()});
+    return *this;
+}
+
+// Writes the columns to a new shared memory segment. Publishing is best
+// effort: false is returned, leaving nothing behind, if the segment already
+// exists or cannot be created.
+inline bool ColumnarInput::publish(std::string const& name,
+                                   std::uint64_t hash) const {
+    std::size_t size =
+        align(sizeof(SegmentHeader) + columns.size() * sizeof(SegmentColumn));
+    std::vector<SegmentColumn> descriptors;
+    for (Column const& c : columns) {
+        std::uint32_t element_size = c.type & 0xff;
+        descriptors.push_back({c.type, element_size, c.count, size});
+        size += align(c.count * element_size);
+    }
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    void* addr = MAP_FAILED;
+    if (ftruncate(fd, size) == 0) {
+        addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (addr == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    char* base = static_cast<char*>(addr);
+    auto* header =
+        new (base) SegmentHeader{MAGIC, hash, size, columns.size(), {0}};
+    std::memcpy(base + sizeof(SegmentHeader), descriptors.data(),
+                descriptors.size() * sizeof(SegmentColumn));
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+        std::memcpy(base + descriptors[i].offset, columns[i].data,
+                    descriptors[i].count * descriptors[i].element_size);
+    }
+    header->ready.store(1, std::memory_order_release);
+    munmap(addr, size);
+    return true;
+}
+
+// Maps an existing shared memory segment read-only into `result`. Returns
+// false if the segment doesn't exist, isn't owned by the effective user, is
+// still being written, or doesn't look like a valid segment for the given
+// hash.
+inline bool ColumnarInput::attach(std::string const& name, std::uint64_t hash,
+                                  ColumnarInput& result) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    void* addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_uid == geteuid() &&
+        static_cast<std::size_t>(st.st_size) >= sizeof(SegmentHeader)) {
+        addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+    std::size_t size = st.st_size;
+    std::shared_ptr<void> mapping(
+        addr, [size](void* addr) { munmap(addr, size); });
+
+    const char* base = static_cast<const char*>(addr);
+    auto const* header = reinterpret_cast<SegmentHeader const*>(base);
+    if (header->magic != MAGIC || header->hash != hash ||
+        header->size != size ||
+        header->ready.load(std::memory_order_acquire) != 1 ||
+        header->n_columns >
+            (size - sizeof(SegmentHeader)) / sizeof(SegmentColumn)) {
+        return false;
+    }
+    auto const* descriptors =
+        reinterpret_cast<SegmentColumn const*>(base + sizeof(SegmentHeader));
+    std::vector<Column> columns;
+    for (std::size_t i = 0; i < header->n_columns; ++i) {
+        SegmentColumn const& d = descriptors[i];
+        if (d.element_size == 0 || d.element_size != (d.type & 0xff) ||
+            d.offset > size ||
+            d.count > (size - d.offset) / d.element_size) {
+            return false;
+        }
+        columns.push_back({d.type, d.count, base + d.offset});
+    }
+    result.columns = std::move(columns);
+    result.owned.clear();
+    result.mapping = std::move(mapping);
+    return true;
+}
+
+inline std::uint64_t hash_file(const char* file_name) {
+    std::ifstream f(file_name, std::ios::binary);
+    if (f.fail()) {
+        throw OpenFailureException(std::string(file_name));
+    }
+    static constexpr std::size_t CHUNK = 1 << 20;
+    std::unique_ptr<char[]> buffer(new char[CHUNK]);
+    std::uint64_t h = 0;
+    do {
+        f.read(buffer.get(), CHUNK);
+        h = mix64(h ^ hash_bytes(buffer.get(), f.gcount(), h));
+    } while (f.gcount() == CHUNK);
+    return h;
+}
+
+inline std::string shared_segment_name(std::uint64_t hash,
+                                       std::string const& schema) {
+    if (schema.empty() || schema.find('/') != std::string::npos) {
+        throw InvalidArgumentException(
+            "Schema must be non-empty and must not contain '/'");
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx",
+                  static_cast<unsigned long long>(hash));
+    return "/cplib-" + schema + "-" + hex;
+}
+
+// Returns the parsed content of `input_file`. If another process already
+// parsed the same content with the same schema, its shared memory segment is
+// attached read-only and no parsing takes place; otherwise `parse` is run on
+// a (non-strict) Reader over the file and the result is published for the
+// following processes. The schema identifies the parsing function, and must
+// change whenever the latter does.
+inline ColumnarInput load_shared(
+    const char* input_file, std::string const& schema,
+    std::function<void(Reader&, ColumnarInput&)> const& parse) {
+    std::uint64_t hash = hash_file(input_file);
+    std::string name = shared_segment_name(hash, schema);
+    ColumnarInput input;
+    if (ColumnarInput::attach(name, hash, input)) {
+        return input;
+    }
+    Reader r(input_file);
+    parse(r, input);
+    input.publish(name, hash);
+    return input;
+}
+
+// Removes the shared memory segment published for `input_file`, if any.
+inline void unlink_shared(const char* input_file, std::string const& schema) {
+    shm_unlink(shared_segment_name(hash_file(input_file), schema).c_str());
+}
+
+}  // namespace cplib::io
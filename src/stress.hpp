@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "checker.hpp"
+#include "generator.hpp"
+#include "io.hpp"
+#include "process.hpp"
+#include "thread_pool.hpp"
+
+namespace cplib::stress {
+
+struct Failure {
+    enum class Kind {
+        // The checker rejected the output of the solution.
+        MISMATCH,
+        // The solution crashed or timed out.
+        SOLUTION_ERROR,
+        // The brute force crashed or timed out.
+        BRUTE_FORCE_ERROR
+    };
+
+    // The test is generated by gen::Random(seed).
+    std::uint64_t seed = 0;
+    std::string input;
+    std::string expected_output;
+    std::string output;
+    std::string message;
+    Kind kind = Kind::MISMATCH;
+
+    // Writes <prefix>.in, <prefix>.expected, <prefix>.out and <prefix>.log
+    // (with the seed and the message).
+    void save(std::string const& prefix) const;
+};
+
+inline void Failure::save(std::string const& prefix) const {
+    std::ofstream(prefix + ".in", std::ios::binary) << input;
+    std::ofstream(prefix + ".expected", std::ios::binary) << expected_output;
+    std::ofstream(prefix + ".out", std::ios::binary) << output;
+    std::ofstream(prefix + ".log")
+        << "seed " << seed << "\n" << message << "\n";
+}
+
+// Runs a solution against a brute force on random tests until they disagree.
+//
+// The i-th test is generated by gen::Random(seed + i), written into memory
+// with an io::Writer, and fed to both programs through pipes. The outputs are
+// compared by the checker (by default, chk::compare_exact), which reports a
+// mismatch by throwing chk::WrongAnswerException. A crash or timeout of
+// either program is a failure as well.
+//
+// Tests are run on a pool of workers, which take them in increasing order and
+// stop taking new ones after the first failure: the failure returned is the
+// one with the smallest index, regardless of the number of workers.
+class Harness {
+   public:
+    using Generator = std::function<void(gen::Random&, io::Writer&)>;
+    using Check = std::function<void(std::string const& input,
+                                     std::string_view expected,
+                                     std::string_view output)>;
+
+   private:
+    std::vector<std::string> solution, brute_force;
+    Generator generate;
+    Check check = [](std::string const&, std::string_view expected,
+                     std::string_view output) {
+        chk::compare_exact(expected, output);
+    };
+    std::size_t n_threads = 0;
+    std::chrono::milliseconds timeout{10000};
+
+    std::optional<Failure> run_one(std::uint64_t seed) const;
+
+   public:
+    Harness(std::vector<std::string> solution,
+            std::vector<std::string> brute_force, Generator generate)
+        : solution(std::move(solution)),
+          brute_force(std::move(brute_force)),
+          generate(std::move(generate)) {}
+
+    Harness& with_checker(Check check) {
+        this->check = std::move(check);
+        return *this;
+    }
+    Harness& with_threads(std::size_t n_threads) {
+        this->n_threads = n_threads;
+        return *this;
+    }
+    Harness& with_timeout(std::chrono::milliseconds timeout) {
+        this->timeout = timeout;
+        return *this;
+    }
+
+    // Runs a single test, returning the failure if any (with seed 0).
+    std::optional<Failure> test(std::string input) const;
+
+    // Runs up to `n_tests` tests, returning the first failure if any.
+    std::optional<Failure> run(std::uint64_t seed, std::size_t n_tests) const;
+};
+
+inline std::optional<Failure> Harness::run_one(std::uint64_t seed) const {
+    std::string input;
+    {
+        gen::Random rng(seed);
+        auto* ss = new std::ostringstream();
+        io::Writer w(*ss);
+        generate(rng, w);
+        input = ss->str();
+    }
+    std::optional<Failure> failure = test(std::move(input));
+    if (failure) {
+        failure->seed = seed;
+    }
+    return failure;
+}
+
+inline std::optional<Failure> Harness::test(std::string input) const {
+    Failure failure;
+    failure.input = std::move(input);
+    ProcessResult expected = run_process(brute_force, failure.input, timeout);
+    ProcessResult output = run_process(solution, failure.input, timeout);
+    failure.expected_output = std::move(expected.output);
+    failure.output = std::move(output.output);
+    if (!expected.success()) {
+        failure.message = "Brute force: " + expected.describe();
+        failure.kind = Failure::Kind::BRUTE_FORCE_ERROR;
+    } else if (!output.success()) {
+        failure.message = "Solution: " + output.describe();
+        failure.kind = Failure::Kind::SOLUTION_ERROR;
+    } else {
+        chk::Verdict verdict = chk::judge([&]() {
+            check(failure.input, failure.expected_output, failure.output);
+        });
+        if (!verdict.error && verdict.score == 1.0) {
+            return std::nullopt;
+        }
+        failure.message = verdict.message;
+    }
+    return failure;
+}
+
+inline std::optional<Failure> Harness::run(std::uint64_t seed,
+                                           std::size_t n_tests) const {
+    std::atomic<std::size_t> next = 0;
+    std::atomic<bool> failed = false;
+    std::mutex mutex;
+    std::optional<Failure> first;
+    std::size_t first_index = n_tests;
+
+    ThreadPool pool(n_threads);
+    std::vector<std::future<void>> workers;
+    for (std::size_t t = 0; t < pool.size(); ++t) {
+        workers.push_back(pool.submit([&]() {
+            while (!failed.load()) {
+                std::size_t i = next++;
+                if (i >= n_tests) return;
+                std::optional<Failure> failure;
+                try {
+                    failure = run_one(seed + i);
+                } catch (...) {
+                    failed = true;
+                    throw;
+                }
+                if (failure) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    failed = true;
+                    if (i < first_index) {
+                        first_index = i;
+                        first = std::move(failure);
+                    }
+                }
+            }
+        }));
+    }
+    for (auto& worker : workers) {
+        worker.get();
+    }
+    return first;
+}
+
+}  // namespace cplib::stress
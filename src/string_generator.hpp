@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "common.hpp"
+#include "generator.hpp"
+#include "io.hpp"
+
+namespace cplib::gen {
+
+// Fills out[0..n) with characters drawn uniformly and independently from
+// `alphabet` (a character appearing twice is twice as likely).
+//
+// Each output of the generator is split into 16-bit lanes (32-bit if the
+// alphabet has more than 256 characters), each mapped to a character with
+// Lemire's multiply-and-reject method: there is no modulo bias, and for small
+// alphabets less than one lane in 256 is rejected.
+inline void fill_random_chars(Random& rng, char* out, std::size_t n,
+                              std::string_view alphabet) {
+    if (alphabet.empty()) {
+        throw InvalidArgumentException("Empty alphabet");
+    }
+    if (alphabet.size() > 0xffffffffULL) {
+        throw InvalidArgumentException("Alphabet too large");
+    }
+    std::uint64_t k = alphabet.size();
+    int bits = k <= 256 ? 16 : 32;
+    std::uint64_t lane_mask = (1ULL << bits) - 1;
+    std::uint64_t threshold = ((1ULL << bits) - k) % k;
+    const char* chars = alphabet.data();
+    std::size_t i = 0;
+    while (i < n) {
+        std::uint64_t x = rng();
+        for (int lane = 0; lane < 64 && i < n; lane += bits) {
+            std::uint64_t m = ((x >> lane) & lane_mask) * k;
+            out[i] = chars[m >> bits];
+            i += (m & lane_mask) >= threshold;
+        }
+    }
+}
+
+inline std::string random_string(Random& rng, std::size_t n,
+                                 std::string_view alphabet) {
+    std::string s(n, '\0');
+    fill_random_chars(rng, s.data(), n, alphabet);
+    return s;
+}
+
+// Same as w << random_string(rng, n, alphabet), but in constant memory.
+inline void write_random_string(io::Writer& w, Random& rng, std::size_t n,
+                                std::string_view alphabet) {
+    static constexpr std::size_t CHUNK_SIZE = 1 << 16;
+    std::unique_ptr<char[]> buffer(new char[CHUNK_SIZE]);
+    for (std::size_t done = 0; done < n; done += CHUNK_SIZE) {
+        std::size_t chunk = std::min(CHUNK_SIZE, n - done);
+        fill_random_chars(rng, buffer.get(), chunk, alphabet);
+        w.write_string(buffer.get(), chunk);
+    }
+}
+
+// Returns k distinct characters of `alphabet`, chosen uniformly at random.
+inline std::string random_alphabet(Random& rng, std::string_view alphabet,
+                                   std::size_t k) {
+    std::string distinct(alphabet);
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()),
+                   distinct.end());
+    if (k > distinct.size()) {
+        throw InvalidArgumentException(
+            "Alphabet has less than " + std::to_string(k) +
+            " distinct characters");
+    }
+    rng.shuffle(distinct.begin(), distinct.end());
+    distinct.resize(k);
+    return distinct;
+}
+
+// Random string made of exactly min(k, n) distinct characters of `alphabet`.
+// The characters are chosen at random, and each of them is placed at a random
+// position before filling the rest of the string.
+inline std::string few_distinct_string(Random& rng, std::size_t n,
+                                       std::string_view alphabet,
+                                       std::size_t k) {
+    std::string chars = random_alphabet(rng, alphabet, k);
+    if (chars.empty()) {
+        if (n > 0) {
+            throw InvalidArgumentException(
+                "Cannot build a non-empty string from 0 characters");
+        }
+        return "";
+    }
+    std::string s = random_string(rng, n, chars);
+    RandomPermutation positions(n, rng);
+    for (std::size_t i = 0; i < std::min(k, n); ++i) {
+        s[positions[i]] = chars[i];
+    }
+    return s;
+}
+
+// The prefix of length n of the infinite repetition of a random string of
+// length `period`.
+inline std::string periodic_string(Random& rng, std::size_t n,
+                                   std::string_view alphabet,
+                                   std::size_t period) {
+    if (period == 0) {
+        throw InvalidArgumentException("Period must be positive");
+    }
+    std::string s = random_string(rng, std::min(n, period), alphabet);
+    s.reserve(n);
+    while (s.size() < n) {
+        s.append(s, 0, std::min(s.size(), n - s.size()));
+    }
+    return s;
+}
+
+// The prefix of length n of the infinite Fibonacci word (abaababaabaab...),
+// built by repeated concatenation: f(k) = f(k - 1) + f(k - 2), where f(k - 2)
+// is a prefix of f(k - 1).
+inline std::string fibonacci_word(std::size_t n, char a = 'a', char b = 'b') {
+    std::string s = {a, b};
+    s.reserve(n);
+    std::size_t previous = 1;
+    while (s.size() < n) {
+        std::size_t current = s.size();
+        s.append(s, 0, std::min(previous, n - current));
+        previous = current;
+    }
+    s.resize(n);
+    return s;
+}
+
+// The prefix of length n of the Thue-Morse word (abbabaabbaababba...), whose
+// i-th character is b if and only if i has an odd number of set bits.
+inline std::string thue_morse_word(std::size_t n, char a = 'a', char b = 'b') {
+    std::string s(n, a);
+    char flip = a ^ b;
+    for (std::size_t i = 0; i < n; ++i) {
+        s[i] ^= flip & -static_cast<char>(__builtin_popcountll(i) & 1);
+    }
+    return s;
+}
+
+// Uniformly random balanced bracket sequence of length n (which must be
+// even).
+//
+// Takes a random arrangement of n / 2 open and n / 2 + 1 closed brackets and,
+// by the cycle lemma, rotates it to the unique rotation in which every proper
+// prefix is balanced or has more open brackets, then drops the last (closed)
+// bracket.
+inline std::string random_bracket_sequence(Random& rng, std::size_t n,
+                                           char open = '(', char close = ')') {
+    if (n % 2 != 0) {
+        throw InvalidArgumentException("Length must be even");
+    }
+    std::string s(n / 2, open);
+    s.append(n / 2 + 1, close);
+    rng.shuffle(s.begin(), s.end());
+    std::int64_t depth = 0, min_depth = 0;
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        depth += s[i] == open ? 1 : -1;
+        if (depth < min_depth) {
+            min_depth = depth;
+            start = i + 1;
+        }
+    }
+    std::rotate(s.begin(), s.begin() + start, s.end());
+    s.pop_back();
+    return s;
+}
+
+}  // namespace cplib::gen
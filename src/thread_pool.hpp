@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace cplib {
+
+// A fixed-size pool of worker threads executing tasks in FIFO order.
+// The destructor waits for all the submitted tasks to be completed.
+class ThreadPool {
+   private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+
+    void work();
+
+   public:
+    explicit ThreadPool(std::size_t n_threads = 0);
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    ~ThreadPool();
+
+    std::size_t size() const noexcept { return workers.size(); }
+
+    template <class F>
+    std::future<std::invoke_result_t<F>> submit(F f);
+};
+
+inline ThreadPool::ThreadPool(std::size_t n_threads) {
+    if (n_threads == 0) {
+        n_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(n_threads);
+    for (std::size_t i = 0; i < n_threads; ++i) {
+        workers.emplace_back([this]() { work(); });
+    }
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+inline void ThreadPool::work() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+template <class F>
+std::future<std::invoke_result_t<F>> ThreadPool::submit(F f) {
+    auto task =
+        std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(
+            std::move(f));
+    auto result = task->get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push([task]() { (*task)(); });
+    }
+    cv.notify_one();
+    return result;
+}
+
+}  // namespace cplib
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "io.hpp"
+#include "process.hpp"
+
+namespace cplib::timing {
+
+enum class Mode {
+    // An untimed run precedes the timed ones, so that the input and the
+    // binary are in the page cache.
+    WARM,
+    // The input and the binary are evicted from the page cache before each
+    // run.
+    COLD,
+};
+
+// Summary of a set of measurements, in seconds.
+struct Distribution {
+    double min = 0, median = 0, mean = 0, max = 0, stddev = 0;
+
+    explicit Distribution(std::vector<double> values);
+};
+
+inline Distribution::Distribution(std::vector<double> values) {
+    if (values.empty()) return;
+    std::sort(values.begin(), values.end());
+    std::size_t n = values.size();
+    min = values.front();
+    max = values.back();
+    median = n % 2 == 1 ? values[n / 2]
+                        : (values[n / 2 - 1] + values[n / 2]) / 2;
+    for (double x : values) mean += x;
+    mean /= n;
+    for (double x : values) stddev += (x - mean) * (x - mean);
+    stddev = std::sqrt(stddev / n);
+}
+
+struct TestReport {
+    std::string test;
+    Distribution wall_time, cpu_time;
+    // Maximum over the runs, in bytes.
+    std::size_t peak_memory;
+    // Empty if all the runs succeeded, otherwise the first error.
+    std::string error;
+};
+
+struct Report {
+    std::vector<TestReport> tests;
+    // Margin times the slowest CPU time, rounded up to 100ms (at least 100ms).
+    double suggested_time_limit;
+    // Margin times the largest peak memory, rounded up to 16 MiB (at least
+    // 16 MiB).
+    std::size_t suggested_memory_limit;
+
+    bool success() const noexcept;
+
+    // Writes a table with a line per test, followed by the suggested limits.
+    // All the fields are separated by spaces, so that the report is easy to
+    // parse as well as to read.
+    void write(io::Writer& w) const;
+};
+
+inline bool Report::success() const noexcept {
+    return std::all_of(tests.begin(), tests.end(),
+                       [](TestReport const& t) { return t.error.empty(); });
+}
+
+inline void Report::write(io::Writer& w) const {
+    w.write_string(
+        "test wall_min wall_median wall_max cpu_min cpu_median cpu_max "
+        "cpu_stddev peak_mib status\n");
+    auto seconds = [&w](double x) {
+        w.write_space();
+        w.write_floating_point(x, 3);
+    };
+    for (TestReport const& t : tests) {
+        w.write_string(t.test);
+        seconds(t.wall_time.min);
+        seconds(t.wall_time.median);
+        seconds(t.wall_time.max);
+        seconds(t.cpu_time.min);
+        seconds(t.cpu_time.median);
+        seconds(t.cpu_time.max);
+        seconds(t.cpu_time.stddev);
+        w.write_space();
+        w.write_floating_point(t.peak_memory / 1048576.0, 1);
+        w.write_space();
+        w.write_string(t.error.empty() ? std::string("OK") : "FAILED");
+        w.write_newline();
+    }
+    w.write_string("suggested_time_limit ");
+    w.write_floating_point(suggested_time_limit, 1);
+    w.write_newline();
+    w.write_string("suggested_memory_limit_mib ");
+    w.write_integer(suggested_memory_limit >> 20);
+    w.write_newline();
+}
+
+// Evicts the (clean) pages of a file from the page cache. Unlike dropping all
+// caches, doesn't need privileges.
+inline void evict_from_page_cache(const char* file_name) {
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+// Runs a solution on every test of a task to calibrate its limits. The runs
+// are sequential, with the input read from the test file and the output
+// discarded, and each of them is optionally pinned to a CPU.
+class Runner {
+   private:
+    std::vector<std::string> command;
+    std::size_t repetitions = 5;
+    Mode mode = Mode::WARM;
+    int cpu = -1;
+    double margin = 2.0;
+    std::chrono::milliseconds timeout{60000};
+
+    TestReport run_one(std::string const& test) const;
+
+   public:
+    explicit Runner(std::vector<std::string> command)
+        : command(std::move(command)) {}
+
+    Runner& with_repetitions(std::size_t repetitions) {
+        this->repetitions = std::max<std::size_t>(repetitions, 1);
+        return *this;
+    }
+    Runner& with_mode(Mode mode) {
+        this->mode = mode;
+        return *this;
+    }
+    Runner& with_cpu(int cpu) {
+        this->cpu = cpu;
+        return *this;
+    }
+    Runner& with_margin(double margin) {
+        this->margin = margin;
+        return *this;
+    }
+    Runner& with_timeout(std::chrono::milliseconds timeout) {
+        this->timeout = timeout;
+        return *this;
+    }
+
+    Report run(std::vector<std::string> const& tests) const;
+};
+
+inline TestReport Runner::run_one(std::string const& test) const {
+    ProcessOptions options;
+    options.timeout = timeout;
+    options.input_file = test;
+    options.cpu = cpu;
+    options.collect_output = false;
+    if (mode == Mode::WARM) {
+        run_process(command, "", options);
+    }
+    std::vector<double> wall, cpu_time;
+    TestReport report{test, Distribution({}), Distribution({}), 0, ""};
+    for (std::size_t i = 0; i < repetitions; ++i) {
+        if (mode == Mode::COLD) {
+            evict_from_page_cache(test.c_str());
+            if (command[0].find('/') != std::string::npos) {
+                evict_from_page_cache(command[0].c_str());
+            }
+        }
+        ProcessResult result = run_process(command, "", options);
+        if (!result.success() && report.error.empty()) {
+            report.error = result.describe();
+        }
+        wall.push_back(result.wall_time.count() / 1e6);
+        cpu_time.push_back(result.cpu_time.count() / 1e6);
+        report.peak_memory = std::max(report.peak_memory, result.peak_memory);
+    }
+    report.wall_time = Distribution(wall);
+    report.cpu_time = Distribution(cpu_time);
+    return report;
+}
+
+inline Report Runner::run(std::vector<std::string> const& tests) const {
+    Report report{{}, 0, 0};
+    double slowest = 0;
+    std::size_t largest = 0;
+    for (std::string const& test : tests) {
+        report.tests.push_back(run_one(test));
+        slowest = std::max(slowest, report.tests.back().cpu_time.max);
+        largest = std::max(largest, report.tests.back().peak_memory);
+    }
+    report.suggested_time_limit =
+        std::max(1.0, std::ceil(slowest * margin * 10)) / 10;
+    static constexpr std::size_t MEMORY_UNIT = 16 << 20;
+    double units = std::ceil(largest * margin / MEMORY_UNIT);
+    report.suggested_memory_limit =
+        std::max<std::size_t>(1, units) * MEMORY_UNIT;
+    return report;
+}
+
+}  // namespace cplib::timing
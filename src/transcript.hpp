@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "io.hpp"
+
+namespace cplib::io {
+
+struct TranscriptEntryHeader {
+    // Nanoseconds since the creation of the recorder.
+    std::uint64_t timestamp;
+    std::uint32_t stream;
+    std::uint32_t length;
+};
+
+// Records the bytes exchanged on a set of streams into a compact binary file.
+//
+// Recording only copies the bytes into a lock-free ring buffer, which is
+// drained into the file by a background thread. The ring buffer is
+// single-producer: all the calls to record() must come from the same thread.
+// If the ring buffer is full, record() waits for the background thread.
+//
+// The file is a sequence of entries, each made of a TranscriptEntryHeader
+// followed by the recorded bytes. Writes of more than half the capacity of the
+// ring buffer are split into multiple entries.
+class TranscriptRecorder {
+   private:
+    std::FILE* file;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+
+    std::unique_ptr<char[]> ring;
+    std::size_t capacity;
+    alignas(64) std::atomic<std::uint64_t> head = 0;
+    alignas(64) std::atomic<std::uint64_t> tail = 0;
+    std::atomic<bool> stopping = false;
+    std::thread drainer;
+
+    void copy_in(std::uint64_t position, const char* data, std::size_t n);
+    void drain();
+
+   public:
+    explicit TranscriptRecorder(const char* file_name,
+                                std::size_t capacity = 1 << 20);
+    TranscriptRecorder(TranscriptRecorder const&) = delete;
+
+    // Waits for all the recorded bytes to be written to the file.
+    ~TranscriptRecorder();
+
+    void record(std::uint32_t stream, const char* data,
+                std::size_t n) noexcept;
+};
+
+inline TranscriptRecorder::TranscriptRecorder(const char* file_name,
+                                              std::size_t capacity)
+    : file(std::fopen(file_name, "wb")) {
+    if (file == nullptr) {
+        throw OpenFailureException(std::string(file_name));
+    }
+    this->capacity = 1;
+    while (this->capacity < std::max<std::size_t>(capacity, 1024)) {
+        this->capacity <<= 1;
+    }
+    ring.reset(new char[this->capacity]);
+    drainer = std::thread([this]() { drain(); });
+}
+
+inline TranscriptRecorder::~TranscriptRecorder() {
+    stopping.store(true, std::memory_order_release);
+    drainer.join();
+    std::fclose(file);
+}
+
+inline void TranscriptRecorder::copy_in(std::uint64_t position,
+                                        const char* data, std::size_t n) {
+    std::size_t offset = position & (capacity - 1);
+    std::size_t first = std::min(n, capacity - offset);
+    std::memcpy(ring.get() + offset, data, first);
+    std::memcpy(ring.get(), data + first, n - first);
+}
+
+inline void TranscriptRecorder::record(std::uint32_t stream, const char* data,
+                                       std::size_t n) noexcept {
+    std::uint64_t timestamp =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count();
+    std::size_t max_chunk = capacity / 2 - sizeof(TranscriptEntryHeader);
+    do {
+        std::size_t chunk = std::min(n, max_chunk);
+        TranscriptEntryHeader header{timestamp, stream,
+                                     static_cast<std::uint32_t>(chunk)};
+        std::size_t total = sizeof(TranscriptEntryHeader) + chunk;
+        std::uint64_t h = head.load(std::memory_order_relaxed);
+        while (h + total - tail.load(std::memory_order_acquire) > capacity) {
+            std::this_thread::yield();
+        }
+        copy_in(h, reinterpret_cast<const char*>(&header),
+                sizeof(TranscriptEntryHeader));
+        copy_in(h + sizeof(TranscriptEntryHeader), data, chunk);
+        head.store(h + total, std::memory_order_release);
+        data += chunk;
+        n -= chunk;
+    } while (n > 0);
+}
+
+inline void TranscriptRecorder::drain() {
+    while (true) {
+        bool stop = stopping.load(std::memory_order_acquire);
+        std::uint64_t t = tail.load(std::memory_order_relaxed);
+        std::uint64_t h = head.load(std::memory_order_acquire);
+        if (h != t) {
+            std::size_t offset = t & (capacity - 1);
+            std::size_t first = std::min<std::size_t>(h - t, capacity - offset);
+            std::fwrite(ring.get() + offset, 1, first, file);
+            std::fwrite(ring.get(), 1, h - t - first, file);
+            tail.store(h, std::memory_order_release);
+        } else if (stop) {
+            std::fflush(file);
+            return;
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    }
+}
+
+struct TranscriptEntry {
+    std::uint64_t timestamp;
+    std::uint32_t stream;
+    std::string data;
+};
+
+inline std::vector<TranscriptEntry> read_transcript(const char* file_name) {
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> f(
+        std::fopen(file_name, "rb"), std::fclose);
+    if (f == nullptr) {
+        throw OpenFailureException(std::string(file_name));
+    }
+    std::vector<TranscriptEntry> entries;
+    TranscriptEntryHeader header;
+    while (std::fread(&header, sizeof(header), 1, f.get()) == 1) {
+        std::string data(header.length, '\0');
+        if (std::fread(data.data(), 1, header.length, f.get()) !=
+            header.length) {
+            throw IOException("Truncated transcript");
+        }
+        entries.push_back({header.timestamp, header.stream, std::move(data)});
+    }
+    return entries;
+}
+
+// Input stream recording everything it reads from `source` (e.g. the buffer
+// of std::cin), to be passed to an io::Reader.
+//
+// Whatever the source has available is read (and recorded) at once. Sources
+// that can't tell, like std::cin synced with stdio, are read byte by byte, and
+// the bytes are recorded together at the end of each line.
+class RecordingIStream : public std::istream {
+   private:
+    class Buffer : public std::streambuf {
+       private:
+        std::streambuf* source;
+        TranscriptRecorder& recorder;
+        std::uint32_t stream;
+        char data[1 << 12];
+        // data[recorded, egptr()) was read but isn't recorded yet.
+        char* recorded = data;
+
+        void record_pending() {
+            if (egptr() > recorded) {
+                recorder.record(stream, recorded, egptr() - recorded);
+                recorded = egptr();
+            }
+        }
+
+       protected:
+        int_type underflow() override {
+            char* end = egptr() == nullptr ? data : egptr();
+            if (end == data + sizeof(data)) {
+                record_pending();
+                end = recorded = data;
+            }
+            std::streamsize n = std::min<std::streamsize>(
+                std::max<std::streamsize>(source->in_avail(), 1),
+                data + sizeof(data) - end);
+            n = source->sgetn(end, n);
+            setg(data, end, end + n);
+            if (n != 1 || *end == '\n') {
+                record_pending();
+            }
+            return n == 0 ? traits_type::eof() : traits_type::to_int_type(*end);
+        }
+
+       public:
+        Buffer(std::streambuf* source, TranscriptRecorder& recorder,
+               std::uint32_t stream)
+            : source(source), recorder(recorder), stream(stream) {}
+        ~Buffer() { record_pending(); }
+    } buffer;
+
+   public:
+    RecordingIStream(std::streambuf* source, TranscriptRecorder& recorder,
+                     std::uint32_t stream)
+        : std::istream(nullptr), buffer(source, recorder, stream) {
+        rdbuf(&buffer);
+    }
+};
+
+// Output stream recording everything it writes to `dest` (e.g. the buffer of
+// std::cout) upon flush, to be passed to an io::Writer.
+class RecordingOStream : public std::ostream {
+   private:
+    class Buffer : public std::streambuf {
+       private:
+        std::streambuf* dest;
+        TranscriptRecorder& recorder;
+        std::uint32_t stream;
+        char data[1 << 12];
+
+        bool forward() {
+            std::streamsize n = pptr() - pbase();
+            if (n > 0) {
+                recorder.record(stream, pbase(), n);
+                if (dest->sputn(pbase(), n) != n) {
+                    return false;
+                }
+            }
+            setp(data, data + sizeof(data));
+            return true;
+        }
+
+       protected:
+        int_type overflow(int_type c) override {
+            if (!forward()) {
+                return traits_type::eof();
+            }
+            if (c != traits_type::eof()) {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+            return traits_type::not_eof(c);
+        }
+        int sync() override { return forward() ? dest->pubsync() : -1; }
+
+       public:
+        Buffer(std::streambuf* dest, TranscriptRecorder& recorder,
+               std::uint32_t stream)
+            : dest(dest), recorder(recorder), stream(stream) {
+            setp(data, data + sizeof(data));
+        }
+        ~Buffer() { forward(); }
+    } buffer;
+
+   public:
+    RecordingOStream(std::streambuf* dest, TranscriptRecorder& recorder,
+                     std::uint32_t stream)
+        : std::ostream(nullptr), buffer(dest, recorder, stream) {
+        rdbuf(&buffer);
+    }
+};
+
+}  // namespace cplib::io
@@ -0,0 +1,334 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "generator.hpp"
+#include "io.hpp"
+#include "string_generator.hpp"
+
+namespace cplib::gen {
+
+// A rooted tree on the vertices 0, ..., n - 1, stored as a parent array (the
+// parent of the root is -1).
+//
+// The generators below build the tree with a recognizable labeling (e.g. the
+// root is 0, or the vertices of a path are consecutive): call relabel() before
+// printing it. Edges are listed in the order of the child's label, so after
+// relabel() their order is random too; so is the order of their endpoints,
+// which is otherwise parent first.
+class Tree {
+   private:
+    std::vector<int> parent_;
+    int root_ = -1;
+    // Whether the edge to the parent of each vertex is listed child first.
+    std::vector<bool> flipped;
+
+    std::pair<int, int> edge(int child) const {
+        return !flipped.empty() && flipped[child]
+                   ? std::pair(child, parent_[child])
+                   : std::pair(parent_[child], child);
+    }
+
+   public:
+    // Throws InvalidArgumentException unless `parent` is a tree: exactly one
+    // root, and no cycles.
+    explicit Tree(std::vector<int> parent);
+
+    std::size_t size() const noexcept { return parent_.size(); }
+    int root() const noexcept { return root_; }
+    int parent(int v) const { return parent_[v]; }
+    std::vector<int> const& parents() const noexcept { return parent_; }
+
+    // Applies a uniformly random permutation to the labels, in place, and
+    // orients each edge at random.
+    void relabel(Random& rng);
+
+    // The edges as they are written, ordered by child: (parent, child) pairs
+    // unless relabel() was called.
+    std::vector<std::pair<int, int>> edges() const;
+
+    // Writes one edge per line, adding `offset` to the labels.
+    void write_edges(io::Writer& w, int offset = 1) const;
+};
+
+inline Tree::Tree(std::vector<int> parent) : parent_(std::move(parent)) {
+    int n = parent_.size();
+    for (int v = 0; v < n; ++v) {
+        if (parent_[v] == -1) {
+            if (root_ != -1) {
+                throw InvalidArgumentException("Tree has more than one root");
+            }
+            root_ = v;
+        } else if (parent_[v] < 0 || parent_[v] >= n || parent_[v] == v) {
+            throw InvalidArgumentException("Invalid parent of vertex " +
+                                           std::to_string(v));
+        }
+    }
+    if (n > 0 && root_ == -1) {
+        throw InvalidArgumentException("Tree has no root");
+    }
+    // Walks up from each vertex until a vertex known to reach the root: each
+    // vertex is walked through once.
+    enum State : char { UNKNOWN, ON_PATH, REACHES_ROOT };
+    std::vector<State> state(n, UNKNOWN);
+    if (n > 0) state[root_] = REACHES_ROOT;
+    std::vector<int> path;
+    for (int v = 0; v < n; ++v) {
+        int u = v;
+        while (state[u] == UNKNOWN) {
+            state[u] = ON_PATH;
+            path.push_back(u);
+            u = parent_[u];
+        }
+        if (state[u] == ON_PATH) {
+            throw InvalidArgumentException("Cycle through vertex " +
+                                           std::to_string(u));
+        }
+        for (int w : path) state[w] = REACHES_ROOT;
+        path.clear();
+    }
+}
+
+inline void Tree::relabel(Random& rng) {
+    int n = size();
+    std::vector<int> label(n);
+    for (int v = 0; v < n; ++v) label[v] = v;
+    rng.shuffle(label.begin(), label.end());
+    std::vector<int> parent(n);
+    for (int v = 0; v < n; ++v) {
+        parent[label[v]] = parent_[v] == -1 ? -1 : label[parent_[v]];
+    }
+    parent_ = std::move(parent);
+    if (root_ != -1) root_ = label[root_];
+    flipped.assign(n, false);
+    for (int v = 0; v < n; ++v) flipped[v] = rng.next(0, 1);
+}
+
+inline std::vector<std::pair<int, int>> Tree::edges() const {
+    std::vector<std::pair<int, int>> result;
+    result.reserve(size());
+    for (int v = 0; v < static_cast<int>(size()); ++v) {
+        if (parent_[v] != -1) result.push_back(edge(v));
+    }
+    return result;
+}
+
+inline void Tree::write_edges(io::Writer& w, int offset) const {
+    for (int v = 0; v < static_cast<int>(size()); ++v) {
+        if (parent_[v] == -1) continue;
+        auto [a, b] = edge(v);
+        w.write_integer(a + offset);
+        w.write_space();
+        w.write_integer(b + offset);
+        w.write_newline();
+    }
+}
+
+// Decodes a Prüfer code in linear time. The tree is rooted at n - 1, the last
+// vertex to be removed.
+inline Tree from_prufer_code(std::vector<int> const& code) {
+    int n = code.size() + 2;
+    std::vector<int> degree(n, 1);
+    for (int x : code) {
+        if (x < 0 || x >= n) {
+            throw InvalidArgumentException("Invalid Prüfer code");
+        }
+        ++degree[x];
+    }
+    std::vector<int> parent(n);
+    int next = 0;
+    while (degree[next] != 1) ++next;
+    int leaf = next;
+    for (int x : code) {
+        parent[leaf] = x;
+        if (--degree[x] == 1 && x < next) {
+            leaf = x;
+        } else {
+            ++next;
+            while (degree[next] != 1) ++next;
+            leaf = next;
+        }
+    }
+    parent[leaf] = n - 1;
+    parent[n - 1] = -1;
+    return Tree(std::move(parent));
+}
+
+// Uniformly random labeled tree on n vertices.
+inline Tree random_tree(Random& rng, int n) {
+    if (n <= 0) {
+        throw InvalidArgumentException("Tree must have at least one vertex");
+    }
+    if (n == 1) return Tree({-1});
+    std::vector<int> code(n - 2);
+    for (int& x : code) x = rng.next(0, n - 1);
+    return from_prufer_code(code);
+}
+
+// Random tree of depth exactly `depth`, rooted at 0: a path 0, ..., depth,
+// plus vertices attached to random vertices at depth less than `depth`.
+inline Tree random_tree_with_depth(Random& rng, int n, int depth) {
+    if (depth < 0 || depth >= n || (depth == 0 && n > 1)) {
+        throw InvalidArgumentException(
+            "No tree on " + std::to_string(n) + " vertices has depth " +
+            std::to_string(depth));
+    }
+    std::vector<int> parent(n), level(n), eligible;
+    parent[0] = -1;
+    for (int v = 0; v < n; ++v) {
+        if (v > 0) {
+            parent[v] = v <= depth ? v - 1 : eligible[rng.next<std::size_t>(
+                                                 0, eligible.size() - 1)];
+            level[v] = level[parent[v]] + 1;
+        }
+        if (level[v] < depth) eligible.push_back(v);
+    }
+    return Tree(std::move(parent));
+}
+
+// Random tree of diameter exactly `diameter`: a path 0, ..., diameter, plus
+// vertices attached so that no vertex gets farther than the nearest end of
+// the path is from the vertex of the path it hangs from. Rooted at 0.
+inline Tree random_tree_with_diameter(Random& rng, int n, int diameter) {
+    if (diameter < 0 || diameter >= n || (diameter < 2 && n > diameter + 1)) {
+        throw InvalidArgumentException(
+            "No tree on " + std::to_string(n) + " vertices has diameter " +
+            std::to_string(diameter));
+    }
+    // How much farther each vertex can have descendants hanging from it.
+    std::vector<int> parent(n), budget(n), eligible;
+    for (int v = 0; v < n; ++v) {
+        if (v <= diameter) {
+            parent[v] = v - 1;
+            budget[v] = std::min(v, diameter - v);
+        } else {
+            parent[v] =
+                eligible[rng.next<std::size_t>(0, eligible.size() - 1)];
+            budget[v] = budget[parent[v]] - 1;
+        }
+        if (budget[v] > 0) eligible.push_back(v);
+    }
+    return Tree(std::move(parent));
+}
+
+// Random tree in which every vertex has degree at most `max_degree`, rooted at
+// 0. Each vertex is attached to a uniformly random vertex of degree less than
+// `max_degree`.
+inline Tree random_tree_with_max_degree(Random& rng, int n, int max_degree) {
+    if (n <= 0 || (n > 1 && max_degree < 1) || (n > 2 && max_degree < 2)) {
+        throw InvalidArgumentException(
+            "No tree on " + std::to_string(n) +
+            " vertices has maximum degree " + std::to_string(max_degree));
+    }
+    std::vector<int> parent(n), degree(n), eligible;
+    std::vector<int> position(n, -1);
+    parent[0] = -1;
+    for (int v = 0; v < n; ++v) {
+        if (v > 0) {
+            int p = eligible[rng.next<std::size_t>(0, eligible.size() - 1)];
+            parent[v] = p;
+            degree[v] = 1;
+            if (++degree[p] == max_degree) {
+                int last = eligible.back();
+                eligible[position[p]] = last;
+                position[last] = position[p];
+                eligible.pop_back();
+            }
+        }
+        if (degree[v] < max_degree) {
+            position[v] = eligible.size();
+            eligible.push_back(v);
+        }
+    }
+    return Tree(std::move(parent));
+}
+
+// Random tree with exactly `leaves` leaves (vertices of degree 1), built from
+// a random Prüfer code using exactly n - leaves distinct vertices.
+inline Tree random_tree_with_leaves(Random& rng, int n, int leaves) {
+    if (n <= 2) {
+        if (leaves != (n == 2 ? 2 : 0)) {
+            throw InvalidArgumentException(
+                "No tree on " + std::to_string(n) + " vertices has " +
+                std::to_string(leaves) + " leaves");
+        }
+        return Tree(n == 1 ? std::vector<int>{-1} : std::vector<int>{1, -1});
+    }
+    if (leaves < 2 || leaves >= n) {
+        throw InvalidArgumentException(
+            "No tree on " + std::to_string(n) + " vertices has " +
+            std::to_string(leaves) + " leaves");
+    }
+    std::vector<int> vertices(n);
+    for (int v = 0; v < n; ++v) vertices[v] = v;
+    rng.shuffle(vertices.begin(), vertices.end());
+    int internal = n - leaves;
+    std::vector<int> code(n - 2);
+    for (int i = 0; i < n - 2; ++i) {
+        code[i] = vertices[i < internal ? i : rng.next(0, internal - 1)];
+    }
+    rng.shuffle(code.begin(), code.end());
+    return from_prufer_code(code);
+}
+
+// Uniformly random binary tree (every vertex has at most two children) on n
+// vertices, decoded from a random balanced bracket sequence: the sequence
+// (A)B is the tree whose root has subtrees A and B. Rooted at 0.
+inline Tree random_binary_tree(Random& rng, int n) {
+    if (n <= 0) {
+        throw InvalidArgumentException("Tree must have at least one vertex");
+    }
+    std::string s = random_bracket_sequence(rng, 2 * n);
+    std::vector<int> parent(n), open;
+    int next = 0, last_closed = -1;
+    for (char c : s) {
+        if (c == '(') {
+            int v = next++;
+            if (last_closed != -1) {
+                parent[v] = last_closed;
+            } else {
+                parent[v] = open.empty() ? -1 : open.back();
+            }
+            last_closed = -1;
+            open.push_back(v);
+        } else {
+            last_closed = open.back();
+            open.pop_back();
+        }
+    }
+    return Tree(std::move(parent));
+}
+
+// A path 0, ..., spine - 1, with the other vertices attached to uniformly
+// random vertices of the path. Rooted at 0.
+inline Tree caterpillar(Random& rng, int n, int spine) {
+    if (spine <= 0 || spine > n) {
+        throw InvalidArgumentException("Spine must have between 1 and " +
+                                       std::to_string(n) + " vertices");
+    }
+    std::vector<int> parent(n);
+    for (int v = 0; v < n; ++v) {
+        parent[v] = v < spine ? v - 1 : rng.next(0, spine - 1);
+    }
+    return Tree(std::move(parent));
+}
+
+// A path 0, ..., handle - 1, with the other vertices attached to its last
+// vertex. Rooted at 0.
+inline Tree broom(int n, int handle) {
+    if (handle <= 0 || handle > n) {
+        throw InvalidArgumentException("Handle must have between 1 and " +
+                                       std::to_string(n) + " vertices");
+    }
+    std::vector<int> parent(n);
+    for (int v = 0; v < n; ++v) {
+        parent[v] = v < handle ? v - 1 : handle - 1;
+    }
+    return Tree(std::move(parent));
+}
+
+}  // namespace cplib::gen
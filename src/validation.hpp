@@ -1,15 +1,21 @@
+#pragma once
+
 #include <algorithm>
 #include <cstdio>
 #include <functional>
 #include <iostream>
-#include <regex>
 #include <set>
 #include <string>
 #include <variant>
 #include <vector>
 
+#include "interning.hpp"
 #include "io.hpp"
 
+#ifndef CPLIB_DECLARATIONS_ONLY
+#include <regex>
+#endif
+
 #define ASSERT(f)                                                           \
     {                                                                       \
         auto x = f;                                                         \
@@ -26,10 +32,7 @@ class ValidationResult {
    private:
     std::variant<std::string, FailedValidationException> const outcome;
 
-    static std::string indent(std::string s) {
-        static const std::string indent = "  ";
-        return indent + std::regex_replace(s, std::regex("\\n"), "\n" + indent);
-    }
+    static std::string indent(std::string s);
 
    public:
     explicit ValidationResult() = default;
@@ -61,15 +64,21 @@ class ValidationResult {
                                        ValidationResult const& b);
 };
 
-ValidationResult ValidationResult::operator!() const {
+#ifndef CPLIB_DECLARATIONS_ONLY
+CPLIB_INLINE std::string ValidationResult::indent(std::string s) {
+    static const std::string indent = "  ";
+    return indent + std::regex_replace(s, std::regex("\\n"), "\n" + indent);
+}
+
+CPLIB_INLINE ValidationResult ValidationResult::operator!() const {
     if (success()) {
         return FailedValidationException("NOT\n" + indent(message()));
     }
     return "NOT\n" + indent(message());
 }
 
-ValidationResult operator&&(ValidationResult const& a,
-                            ValidationResult const& b) {
+CPLIB_INLINE ValidationResult operator&&(ValidationResult const& a,
+                                         ValidationResult const& b) {
     std::string new_message = ValidationResult::indent(a.message()) +
                               "\nAND\n" + ValidationResult::indent(b.message());
     if (a.success() && b.success()) {
@@ -78,8 +87,8 @@ ValidationResult operator&&(ValidationResult const& a,
     return FailedValidationException(new_message);
 }
 
-ValidationResult operator||(ValidationResult const& a,
-                            ValidationResult const& b) {
+CPLIB_INLINE ValidationResult operator||(ValidationResult const& a,
+                                         ValidationResult const& b) {
     std::string new_message = ValidationResult::indent(a.message()) + "\nOR\n" +
                               ValidationResult::indent(b.message());
     if (a.success() || b.success()) {
@@ -87,6 +96,7 @@ ValidationResult operator||(ValidationResult const& a,
     }
     return FailedValidationException(new_message);
 }
+#endif
 
 template <class T>
 ValidationResult eq(T const& a, T const& b) {
@@ -153,6 +163,7 @@ ValidationResult between(T const& x, T const& low, T const& high) {
 
 template <class It, class P>
 ValidationResult all(It const& begin, It const& end, P const& predicate) {
+    CPLIB_PROFILE_REGION("val::all");
     for (It it = begin; it != end; it = std::next(it)) {
         ValidationResult res = predicate(*it);
         if (res.failed()) {
@@ -183,6 +194,33 @@ ValidationResult all_between(V const& v, T const& low, T const& high) {
 
 template <class It, class T = std::decay_t<decltype(*std::declval<It>())>>
 ValidationResult distinct(It const& begin, It const& end) {
+    CPLIB_PROFILE_REGION("val::distinct");
+    if constexpr (std::is_same_v<T, std::string>) {
+        // Rather than sorting copies of the strings, intern them: a repeated
+        // one gets an old id. If the probe sequences still get long (the
+        // strings collide, despite the random seed of the interner), they
+        // are sorted instead.
+        static constexpr std::size_t MAX_PROBE_LENGTH = 256;
+        StringInterner seen;
+        std::size_t length = 0;
+        for (It it = begin; it != end; it = std::next(it)) {
+            length += it->size();
+        }
+        seen.reserve(std::distance(begin, end), length);
+        It it = begin;
+        for (; it != end && seen.max_probe_length() <= MAX_PROBE_LENGTH;
+             it = std::next(it)) {
+            std::size_t n = seen.size();
+            if (seen.intern(*it) < n) {
+                return FailedValidationException(
+                    "Elements are not distinct: Multiple occurrences of " +
+                    to_string(*it));
+            }
+        }
+        if (it == end) {
+            return std::string("Elements are distinct");
+        }
+    }
     std::vector<T> v(begin, end);
     std::sort(v.begin(), v.end());
     for (auto it = v.begin(); std::next(it) != v.end(); it = std::next(it)) {
@@ -212,6 +250,7 @@ ValidationResult sorted(It const& begin, It const& end, bool strict = true,
 
 template <class It, class C>
 ValidationResult sorted(It const& begin, It const& end, C const& compare) {
+    CPLIB_PROFILE_REGION("val::sorted");
     for (It it = begin; std::next(it) != end; it = std::next(it)) {
         if (!compare(*it, *std::next(it))) {
             int pos = std::distance(begin, it);
@@ -234,4 +273,21 @@ ValidationResult sorted(std::vector<T> const& v, C const& compare) {
     return sorted(v.begin(), v.end(), compare);
 }
 
+#ifdef CPLIB_COMPILED
+#define CPLIB_INSTANTIATE_CHECKS(T)                                          \
+    CPLIB_INSTANTIATE ValidationResult between<T>(T const&, T const&,        \
+                                                  T const&);                 \
+    CPLIB_INSTANTIATE ValidationResult all_between<std::vector<T>, T>(       \
+        std::vector<T> const&, T const&, T const&);                          \
+    CPLIB_INSTANTIATE ValidationResult distinct<std::vector<T>>(             \
+        std::vector<T> const&);                                              \
+    CPLIB_INSTANTIATE ValidationResult sorted<T>(std::vector<T> const&, bool, \
+                                                 bool);
+
+CPLIB_INSTANTIATE_CHECKS(int)
+CPLIB_INSTANTIATE_CHECKS(long long)
+
+#undef CPLIB_INSTANTIATE_CHECKS
+#endif
+
 }  // namespace cplib::val
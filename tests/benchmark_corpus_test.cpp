@@ -0,0 +1,93 @@
+#include "../src/benchmark_corpus.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace cplib;
+
+std::string generate(bench::Corpus corpus, std::size_t size,
+                     std::uint64_t seed) {
+    auto* ss = new std::ostringstream();
+    io::Writer w(*ss);
+    bench::write_corpus(w, corpus, size, seed);
+    return ss->str();
+}
+
+TEST(BenchmarkCorpusTest, Names_ShouldRoundTrip) {
+    for (bench::Corpus corpus : bench::all_corpora()) {
+        EXPECT_EQ(bench::corpus_from_name(bench::corpus_name(corpus)), corpus);
+    }
+    EXPECT_THROW(bench::corpus_from_name("nope"), InvalidArgumentException);
+}
+
+TEST(BenchmarkCorpusTest, WriteCorpus_ShouldBeDeterministic) {
+    for (bench::Corpus corpus : bench::all_corpora()) {
+        std::string s = generate(corpus, 10000, 42);
+        EXPECT_EQ(s, generate(corpus, 10000, 42));
+        EXPECT_NE(s, generate(corpus, 10000, 43));
+        EXPECT_GT(s.size(), 8000);
+        EXPECT_LT(s.size(), 12000);
+    }
+}
+
+TEST(BenchmarkCorpusTest, WriteCorpus_ShouldBeReadable) {
+    static constexpr std::size_t SIZE = 100000;
+    for (bench::Corpus corpus : bench::all_corpora()) {
+        SCOPED_TRACE(bench::corpus_name(corpus));
+        bool strict = corpus != bench::Corpus::WHITESPACE;
+        io::Reader r(*new std::istringstream(generate(corpus, SIZE, 1)),
+                     strict);
+        switch (corpus) {
+            case bench::Corpus::SMALL_INTEGERS:
+            case bench::Corpus::NEGATIVE_INTEGERS:
+            case bench::Corpus::INT64: {
+                std::size_t n = r.read_integer<std::size_t>();
+                r.must_be_newline();
+                std::vector<long long> v = r.read_n_integers<long long>(
+                    n, std::numeric_limits<long long>::min(),
+                    std::numeric_limits<long long>::max(), " ");
+                r.must_be_newline();
+                if (corpus == bench::Corpus::SMALL_INTEGERS) {
+                    for (long long x : v) EXPECT_TRUE(0 <= x && x <= 99);
+                } else if (corpus == bench::Corpus::NEGATIVE_INTEGERS) {
+                    for (long long x : v) {
+                        EXPECT_TRUE(-1000000000 <= x && x < 0);
+                    }
+                }
+                break;
+            }
+            case bench::Corpus::FLOATS: {
+                std::size_t n = r.read_integer<std::size_t>();
+                r.must_be_newline();
+                std::vector<double> v =
+                    r.read_n_floating_point<double>(n, " ");
+                r.must_be_newline();
+                for (double x : v) EXPECT_LT(std::abs(x), 1e6);
+                break;
+            }
+            case bench::Corpus::LONG_STRINGS:
+            case bench::Corpus::GRID: {
+                std::size_t k = r.read_integer<std::size_t>();
+                r.must_be_space();
+                std::size_t l = r.read_integer<std::size_t>();
+                r.must_be_newline();
+                for (std::size_t i = 0; i < k; ++i) {
+                    EXPECT_EQ(r.read_string(l).size(), l);
+                    r.must_be_newline();
+                }
+                break;
+            }
+            case bench::Corpus::WHITESPACE: {
+                std::size_t n = r.read_integer<std::size_t>();
+                std::vector<int> v = r.read_n_integers<int>(n);
+                for (int x : v) EXPECT_LE(std::abs(x), 1000000000);
+                r.skip_spaces();
+                break;
+            }
+        }
+        r.must_be_eof();
+    }
+}
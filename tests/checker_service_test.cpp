@@ -0,0 +1,146 @@
+#include "../src/checker_service.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace cplib;
+
+class CheckerServiceTest : public testing::Test {
+   protected:
+    std::filesystem::path dir =
+        std::filesystem::path(testing::TempDir()) / "checker_service_test";
+    std::atomic<int> parsed = 0;
+
+    chk::Service<std::string> service = chk::Service<std::string>(
+        [this](std::string const&, std::string const& expected) {
+            ++parsed;
+            return expected;
+        },
+        [](std::string const& expected, std::string_view contestant) {
+            chk::compare_exact(expected, contestant);
+        },
+        4);
+
+    void SetUp() override {
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+    }
+
+    std::string write_file(std::string const& name,
+                           std::string const& content) {
+        std::ofstream(dir / name) << content;
+        return (dir / name).string();
+    }
+};
+
+TEST_F(CheckerServiceTest, Submit_ShouldParseEachTestOnce) {
+    std::string input = write_file("input.txt", "3\n");
+    std::string expected = write_file("expected.txt", "1 2 3\n");
+    std::string correct = write_file("correct.txt", "1 2 3");
+    std::string wrong = write_file("wrong.txt", "1 2 4\n");
+
+    std::vector<std::future<chk::Verdict>> verdicts;
+    for (int i = 0; i < 100; ++i) {
+        verdicts.push_back(
+            service.submit(input, expected, i % 2 == 0 ? correct : wrong));
+    }
+    for (int i = 0; i < 100; ++i) {
+        chk::Verdict verdict = verdicts[i].get();
+        EXPECT_FALSE(verdict.error);
+        EXPECT_EQ(verdict.score, i % 2 == 0 ? 1.0 : 0.0);
+    }
+    EXPECT_EQ(parsed, 1);
+    EXPECT_EQ(service.cached_tests(), 1);
+
+    std::string other_expected = write_file("other_expected.txt", "1 2 4\n");
+    EXPECT_EQ(service.submit(input, other_expected, wrong).get().score, 1.0);
+    EXPECT_EQ(parsed, 2);
+}
+
+TEST_F(CheckerServiceTest, Submit_WithMissingOutput_ShouldGiveWrongAnswer) {
+    std::string input = write_file("input.txt", "3\n");
+    std::string expected = write_file("expected.txt", "1 2 3\n");
+
+    chk::Verdict verdict =
+        service.submit(input, expected, (dir / "missing.txt").string()).get();
+    EXPECT_FALSE(verdict.error);
+    EXPECT_EQ(verdict.score, 0.0);
+}
+
+TEST_F(CheckerServiceTest, Submit_WithMissingExpectedOutput_ShouldGiveError) {
+    std::string input = write_file("input.txt", "3\n");
+    std::string correct = write_file("correct.txt", "1 2 3\n");
+
+    chk::Verdict verdict =
+        service.submit(input, (dir / "missing.txt").string(), correct).get();
+    EXPECT_TRUE(verdict.error);
+}
+
+TEST_F(CheckerServiceTest, Serve_ShouldProcessAllJobs) {
+    std::string input = write_file("input.txt", "3\n");
+    std::string expected = write_file("expected.txt", "1 2 3\n");
+    std::string correct = write_file("correct.txt", "1 2 3");
+    std::string wrong = write_file("wrong.txt", "1 2 4\n");
+    write_file("a.job", input + "\n" + expected + "\n" + correct + "\n");
+    write_file("b.job", input + "\n" + expected + "\n" + wrong + "\n");
+    write_file("stop", "");
+
+    service.serve(dir.string());
+
+    std::string score, message;
+    std::ifstream a(dir / "a.result");
+    std::getline(a, score);
+    EXPECT_EQ(score, "1.0");
+    std::ifstream b(dir / "b.result");
+    std::getline(b, score);
+    std::getline(b, message);
+    EXPECT_EQ(score, "0.0");
+    EXPECT_EQ(message, "Token 3 (line 1): Expected \"3\", found \"4\"");
+    EXPECT_FALSE(std::filesystem::exists(dir / "a.running"));
+    EXPECT_FALSE(std::filesystem::exists(dir / "b.job"));
+}
+
+TEST_F(CheckerServiceTest, Serve_ShouldIgnoreJobsBeingWritten) {
+    std::string input = write_file("input.txt", "3\n");
+    std::string expected = write_file("expected.txt", "1 2 3\n");
+    std::string correct = write_file("correct.txt", "1 2 3");
+    // Written, then renamed to be queued.
+    write_file("a.tmp", input + "\n" + expected + "\n" + correct + "\n");
+    std::filesystem::rename(dir / "a.tmp", dir / "a.job");
+    // Still being written.
+    write_file("b.tmp", input + "\n");
+    write_file("stop", "");
+
+    service.serve(dir.string());
+
+    EXPECT_TRUE(std::filesystem::exists(dir / "a.result"));
+    EXPECT_TRUE(std::filesystem::exists(dir / "b.tmp"));
+    EXPECT_FALSE(std::filesystem::exists(dir / "b.result"));
+}
+
+TEST_F(CheckerServiceTest, Serve_WhenCheckerThrows_ShouldWriteError) {
+    chk::Service<std::string> throwing(
+        [](std::string const&, std::string const& expected) {
+            return expected;
+        },
+        [](std::string const&, std::string_view) { throw 42; });
+    std::string input = write_file("input.txt", "3\n");
+    std::string expected = write_file("expected.txt", "1 2 3\n");
+    write_file("a.job", input + "\n" + expected + "\n" + expected + "\n");
+    write_file("stop", "");
+
+    throwing.serve(dir.string());
+
+    std::string score, message;
+    std::ifstream a(dir / "a.result");
+    std::getline(a, score);
+    std::getline(a, message);
+    EXPECT_EQ(score, "ERROR");
+    EXPECT_EQ(message, "Unknown exception");
+    EXPECT_FALSE(std::filesystem::exists(dir / "a.running"));
+}
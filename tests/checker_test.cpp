@@ -0,0 +1,162 @@
+#include "../src/checker.hpp"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace cplib;
+
+class CheckerTest : public testing::Test {
+   protected:
+    std::string expected_file = testing::TempDir() + "checker_expected.txt";
+    std::string contestant_file =
+        testing::TempDir() + "checker_contestant.txt";
+
+    void write_files(std::string const& expected,
+                     std::string const& contestant) {
+        std::ofstream(expected_file) << expected;
+        std::ofstream(contestant_file) << contestant;
+    }
+};
+
+TEST_F(CheckerTest, MultisetFingerprint_IsOrderInsensitive) {
+    chk::MultisetFingerprint<long long> a(42), b(42), c(42);
+    for (long long x : {5LL, -3LL, 5LL, 1000000000000LL}) a.add(x);
+    for (long long x : {1000000000000LL, 5LL, 5LL, -3LL}) b.add(x);
+    for (long long x : {1000000000000LL, 5LL, -3LL, -3LL}) c.add(x);
+
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(a.size(), 4);
+}
+
+TEST_F(CheckerTest, CompareUnordered_WithSameMultiset_ShouldSucceed) {
+    write_files("3 1 2 2\n", "2\n1 2 3");
+    EXPECT_NO_THROW(chk::compare_unordered<int>(expected_file.c_str(),
+                                                contestant_file.c_str()));
+
+    write_files("bob alice carol\n", "carol\n\talice bob\n");
+    EXPECT_NO_THROW(chk::compare_unordered<std::string>(
+        expected_file.c_str(), contestant_file.c_str()));
+}
+
+TEST_F(CheckerTest, CompareUnordered_WithDifferentMultiset_ShouldThrow) {
+    write_files("3 1 2 2\n", "3 1 1 2\n");
+    try {
+        chk::compare_unordered<int>(expected_file.c_str(),
+                                    contestant_file.c_str());
+        FAIL();
+    } catch (chk::WrongAnswerException const& e) {
+        EXPECT_STREQ(e.what(), "Expected 1 occurrence(s) of 1, found 2");
+    }
+
+    write_files("3 1 2\n", "3 1 2 4\n");
+    EXPECT_THROW(chk::compare_unordered<int>(expected_file.c_str(),
+                                             contestant_file.c_str()),
+                 chk::WrongAnswerException);
+
+    write_files("alice bob\n", "alice bobby\n");
+    EXPECT_THROW(chk::compare_unordered<std::string>(expected_file.c_str(),
+                                                     contestant_file.c_str()),
+                 chk::WrongAnswerException);
+}
+
+TEST_F(CheckerTest, CompareUnordered_WithMalformedOutput_ShouldThrow) {
+    write_files("1 2 3\n", "1 2 99999999999\n");
+    EXPECT_THROW(chk::compare_unordered<int>(expected_file.c_str(),
+                                             contestant_file.c_str()),
+                 chk::WrongAnswerException);
+
+    for (const char* output : {"1 abc 2 3\n", "1 2 3abc\n", "1-2 3\n",
+                               "+1 2 3\n", "1 2 3 .\n"}) {
+        write_files("1 2 3\n", output);
+        EXPECT_THROW(chk::compare_unordered<int>(expected_file.c_str(),
+                                                 contestant_file.c_str()),
+                     chk::WrongAnswerException)
+            << output;
+    }
+}
+
+TEST_F(CheckerTest, CompareExact_WithEquivalentWhitespace_ShouldSucceed) {
+    std::vector<std::pair<std::string, std::string>> cases({
+        {"1 2 3\n", "1 2 3\n"},
+        {"1 2 3\n", "1 2 3"},
+        {"1 2 3\n", "  1\t2\r\n3\n\n"},
+        {"hello world\nfoo\n", "hello   world foo"},
+        {"", "\n"},
+    });
+    for (auto const& [expected, contestant] : cases) {
+        EXPECT_NO_THROW(chk::compare_exact(expected, contestant));
+    }
+}
+
+TEST_F(CheckerTest, CompareExact_WithDifferentTokens_ShouldThrow) {
+    std::vector<std::pair<std::string, std::string>> cases({
+        {"1 2 3\n", "1 2 4\n"},
+        {"12 3\n", "1 23\n"},
+        {"1 2 3\n", "1 2\n"},
+        {"1 2\n", "1 2 3\n"},
+        {"123\n", "1234\n"},
+        {"abc\n", "ab c\n"},
+        {"", "x"},
+    });
+    for (auto const& [expected, contestant] : cases) {
+        EXPECT_THROW(chk::compare_exact(expected, contestant),
+                     chk::WrongAnswerException);
+    }
+}
+
+TEST_F(CheckerTest, CompareExact_ShouldReportFirstDifferingToken) {
+    write_files("first line\nsecond line\nthird line\n",
+                "first line\nsecond\nlane\nthird line\n");
+    try {
+        chk::compare_exact(expected_file.c_str(), contestant_file.c_str());
+        FAIL();
+    } catch (chk::WrongAnswerException const& e) {
+        EXPECT_STREQ(e.what(),
+                     "Token 4 (line 3): Expected \"line\", found \"lane\"");
+    }
+}
+
+TEST_F(CheckerTest, CompareFloatingPoint_WithinTolerance_ShouldSucceed) {
+    auto report = chk::compare_floating_point(
+        std::string("1.0 -2.5\n1000000 0"),
+        std::string("1.0000001 -2.5000001 1000000.5 -0.0000001"), 1e-6);
+
+    EXPECT_TRUE(report.ok());
+    EXPECT_EQ(report.count, 4);
+    EXPECT_NEAR(report.max_abs_error, 0.5, 1e-9);
+    EXPECT_NEAR(report.max_rel_error, 5e-7, 1e-12);
+}
+
+TEST_F(CheckerTest, CompareFloatingPoint_OutsideTolerance_ShouldReport) {
+    std::string expected, contestant;
+    for (int i = 0; i < 10000; ++i) {
+        expected += std::to_string(i) + ".5 ";
+        contestant += std::to_string(i) + (i == 6000 ? ".6 " : ".5 ");
+    }
+    auto report = chk::compare_floating_point(expected, contestant, 1e-6);
+
+    EXPECT_FALSE(report.ok());
+    EXPECT_EQ(report.count, 10000);
+    EXPECT_EQ(report.first_violation, 6000);
+    EXPECT_DOUBLE_EQ(report.expected_value, 6000.5);
+    EXPECT_DOUBLE_EQ(report.contestant_value, 6000.6);
+}
+
+TEST_F(CheckerTest, CompareFloatingPoint_WithMalformedOutput_ShouldThrow) {
+    EXPECT_THROW(chk::compare_floating_point(std::string("1.5 2.5"),
+                                             std::string("1.5"), 1e-6),
+                 chk::WrongAnswerException);
+    EXPECT_THROW(chk::compare_floating_point(std::string("1.5 2.5"),
+                                             std::string("1.5 2.5 3"), 1e-6),
+                 chk::WrongAnswerException);
+    EXPECT_THROW(chk::compare_floating_point(std::string("1.5 2.5"),
+                                             std::string("1.5 nan"), 1e-6),
+                 chk::WrongAnswerException);
+    EXPECT_THROW(chk::compare_floating_point(std::string("1.5 2.5"),
+                                             std::string("1.5 2.5x"), 1e-6),
+                 chk::WrongAnswerException);
+}
@@ -0,0 +1,65 @@
+// Uses the compiled library: the common instantiations are only declared
+// here, and linked from src/cplib.cpp.
+#ifndef CPLIB_COMPILED
+#define CPLIB_COMPILED
+#endif
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/io.hpp"
+#include "../src/validation.hpp"
+
+using namespace cplib;
+
+TEST(CompiledLibraryTest, Reader_ShouldUseCompiledInstantiations) {
+    io::Reader r(*new std::istringstream(
+                     "3 -7 123456789012\n1.5 2.25\nab cd\n1 2\n3 4\n9\n"),
+                 true);
+    EXPECT_EQ(r.read_integer<int>(0, 10), 3);
+    r.must_be_space();
+    EXPECT_EQ(r.read<int>(), -7);
+    r.must_be_space();
+    EXPECT_EQ(r.read<long long>(), 123456789012LL);
+    r.must_be_newline();
+    EXPECT_EQ(r.read<double>(2), std::vector<double>({1.5, 2.25}));
+    r.must_be_newline();
+    EXPECT_EQ(r.read<std::string>(2), std::vector<std::string>({"ab", "cd"}));
+    r.must_be_newline();
+    std::vector<std::vector<int>> m = {{1, 2}, {3, 4}};
+    EXPECT_EQ(r.read<int>(2, 2), m);
+    r.must_be_newline();
+    // Not one of the compiled instantiations.
+    EXPECT_EQ(r.read<short>(), 9);
+    r.must_be_newline();
+    r.must_be_eof();
+}
+
+TEST(CompiledLibraryTest, Writer_ShouldUseCompiledInstantiations) {
+    auto* ss = new std::ostringstream();
+    io::Writer w(*ss);
+    w.write_integer(42);
+    w.write_space();
+    w.write_integer(-1LL);
+    w.write_space();
+    w.write_floating_point(0.5, 2);
+    w.write_newline();
+    EXPECT_EQ(ss->str(), "42 -1 0.50\n");
+}
+
+TEST(CompiledLibraryTest, Validation_ShouldUseCompiledInstantiations) {
+    std::vector<int> v = {1, 3, 2};
+    EXPECT_TRUE(val::between(2, 1, 3));
+    EXPECT_TRUE(val::all_between(v, 1, 3));
+    EXPECT_TRUE(val::distinct(v));
+    EXPECT_FALSE(val::sorted(v, true, false));
+    std::vector<long long> w = {1, 1};
+    EXPECT_FALSE(val::distinct(w));
+    val::ValidationResult result =
+        val::between(5, 1, 3) || !val::distinct(std::vector<int>{1, 2});
+    EXPECT_TRUE(result.failed());
+    EXPECT_NE(result.message().find("\nOR\n  NOT\n"), std::string::npos);
+}
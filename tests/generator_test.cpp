@@ -0,0 +1,199 @@
+#include "../src/generator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/validation.hpp"
+
+using namespace cplib;
+
+std::string read_file(std::string const& file_name) {
+    std::ifstream f(file_name);
+    return std::string(std::istreambuf_iterator<char>(f), {});
+}
+
+TEST(RandomTest, Next_ShouldStayInRange) {
+    gen::Random rng(42);
+    std::set<int> seen;
+    for (int i = 0; i < 10000; ++i) {
+        int x = rng.next(-3, 3);
+        EXPECT_TRUE(val::between(x, -3, 3));
+        seen.insert(x);
+    }
+    EXPECT_EQ(seen.size(), 7);
+
+    EXPECT_EQ(rng.next(5, 5), 5);
+    EXPECT_NO_THROW(rng.next(Limits<long long>::MIN, Limits<long long>::MAX));
+    EXPECT_THROW(rng.next(1, 0), InvalidArgumentException);
+}
+
+TEST(RandomTest, Next_WithNarrowTypes_ShouldStayInRange) {
+    gen::Random rng(42);
+    std::set<int> seen_int8, seen_short;
+    for (int i = 0; i < 10000; ++i) {
+        std::int8_t x = rng.next<std::int8_t>(-2, 2);
+        EXPECT_TRUE(val::between<int>(x, -2, 2));
+        seen_int8.insert(x);
+        short y = rng.next<short>(-300, 300);
+        EXPECT_TRUE(val::between<int>(y, -300, 300));
+        seen_short.insert(y);
+    }
+    EXPECT_EQ(seen_int8.size(), 5);
+    EXPECT_EQ(seen_short.size(), 601);
+
+    std::set<int> seen;
+    for (int i = 0; i < 10000; ++i) {
+        seen.insert(rng.next<std::int8_t>(Limits<std::int8_t>::MIN,
+                                          Limits<std::int8_t>::MAX));
+    }
+    EXPECT_EQ(seen.size(), 256);
+}
+
+TEST(RandomTest, Split_ShouldGiveIndependentStreams) {
+    gen::Random a(7), b(7);
+    gen::Random a1 = a.split(), a2 = a.split();
+    gen::Random b1 = b.split();
+    EXPECT_EQ(a1(), b1());
+    EXPECT_NE(a1(), a2());
+}
+
+void gen_array(gen::Random& rng, io::Writer& w, int n, int max_value) {
+    w << n << "\n";
+    std::vector<int> v(n);
+    for (int& x : v) x = rng.next(1, max_value);
+    w << v << "\n";
+}
+
+TEST(DriverTest, Run_ShouldNotDependOnThreads) {
+    std::vector<std::string> outputs[2];
+    for (int k = 0; k < 2; ++k) {
+        gen::Driver driver(1234, k == 0 ? 1 : 8);
+        for (int i = 0; i < 20; ++i) {
+            driver.add(testing::TempDir() + "driver_" + std::to_string(i) +
+                           ".txt",
+                       gen_array, 10 + i, 1000);
+        }
+        for (auto const& result : driver.run()) {
+            EXPECT_TRUE(result.success) << result.message;
+            outputs[k].push_back(read_file(result.file_name));
+        }
+    }
+    EXPECT_EQ(outputs[0], outputs[1]);
+    EXPECT_NE(outputs[0][0].substr(3), outputs[0][1].substr(3));
+}
+
+TEST(DriverTest, Run_WithValidator_ShouldReportInvalidTests) {
+    gen::Driver driver(1);
+    driver.with_validator([](const char* file_name) {
+        auto r = io::Reader(file_name, /* strict */ true);
+        int n = r.read_integer<int>(1, 100);
+        r.must_be_newline();
+        auto v = r.read<int>(n);
+        ASSERT(val::all_between(v, 1, 10));
+        r.must_be_newline();
+        r.must_be_eof();
+    });
+    driver.add(testing::TempDir() + "valid.txt", gen_array, 50, 10);
+    driver.add(testing::TempDir() + "invalid.txt", gen_array, 50, 1000);
+
+    auto results = driver.run();
+    EXPECT_TRUE(results[0].success);
+    EXPECT_FALSE(results[1].success);
+}
+
+void validate_array(io::Reader& r) {
+    int n = r.read_integer<int>(1, 1000000);
+    r.must_be_newline();
+    auto v = r.read<int>(n);
+    ASSERT(val::all_between(v, 1, 10));
+    r.must_be_newline();
+    r.must_be_eof();
+}
+
+TEST(DriverTest, Run_WithStreamValidator_ShouldOnlyWriteValidTests) {
+    std::string valid = testing::TempDir() + "stream_valid.txt";
+    std::string invalid = testing::TempDir() + "stream_invalid.txt";
+    std::remove(valid.c_str());
+    std::remove(invalid.c_str());
+
+    gen::Driver driver(1);
+    driver.with_stream_validator(validate_array);
+    driver.add(valid, gen_array, 200000, 10);
+    driver.add(invalid, gen_array, 200000, 1000);
+
+    auto results = driver.run();
+    EXPECT_TRUE(results[0].success) << results[0].message;
+    EXPECT_FALSE(results[1].success);
+    EXPECT_FALSE(std::ifstream(invalid).good());
+
+    std::ostringstream* expected = new std::ostringstream();
+    io::Writer w(*expected);
+    gen::Random rng = gen::Random(1).split();
+    gen_array(rng, w, 200000, 10);
+    EXPECT_EQ(read_file(valid), expected->str());
+}
+
+TEST(DriverTest, Run_WithStreamValidator_ShouldStopInvalidTests) {
+    std::string file_name = testing::TempDir() + "stream_huge.txt";
+    std::remove(file_name.c_str());
+
+    // About 20 GB: only feasible if generation stops at the first error.
+    auto gen_huge = [](gen::Random&, io::Writer& w) {
+        for (long long i = 0; i < 2'000'000'000; ++i) {
+            w.write_string("1234567890");
+        }
+    };
+    auto validate_small = [](io::Reader& r) { r.read_integer<int>(1, 100); };
+    gen::Driver driver(1);
+    driver.with_stream_validator(validate_small);
+    driver.add(file_name, gen_huge);
+
+    auto results = driver.run();
+    EXPECT_FALSE(results[0].success);
+    EXPECT_FALSE(std::ifstream(file_name).good());
+    EXPECT_FALSE(std::ifstream(file_name + ".tmp").good());
+}
+
+TEST(RandomPermutationTest, ShouldBeABijection) {
+    gen::Random rng(3);
+    for (std::uint64_t n : {0, 1, 2, 3, 10, 1000, 4096, 4097, 100000}) {
+        gen::RandomPermutation p(n, rng, 1);
+        std::vector<std::uint64_t> v(p.begin(), p.end());
+        ASSERT_EQ(v.size(), n);
+        std::sort(v.begin(), v.end());
+        for (std::uint64_t i = 0; i < n; ++i) {
+            ASSERT_EQ(v[i], i + 1);
+        }
+    }
+}
+
+TEST(RandomPermutationTest, ShouldBeReproducible) {
+    gen::Random a(5), b(5), c(6);
+    gen::RandomPermutation p(1000000000, a), q(1000000000, b),
+        r(1000000000, c);
+    int same_as_r = 0;
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        EXPECT_EQ(p[i], q[i]);
+        EXPECT_LT(p[i], 1000000000);
+        same_as_r += p[i] == r[i];
+    }
+    EXPECT_LT(same_as_r, 5);
+
+    std::ostringstream* ss = new std::ostringstream();
+    io::Writer w(*ss);
+    gen::RandomPermutation s(5, a, 1);
+    w << s;
+    std::vector<int> v;
+    std::istringstream in(ss->str());
+    for (int x; in >> x;) v.push_back(x);
+    std::sort(v.begin(), v.end());
+    EXPECT_EQ(v, std::vector<int>({1, 2, 3, 4, 5}));
+}
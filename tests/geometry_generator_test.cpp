@@ -0,0 +1,106 @@
+#include "../src/geometry_generator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+using namespace cplib;
+
+bool in_range(std::vector<gen::Point> const& points, long long max_value) {
+    return std::all_of(points.begin(), points.end(), [&](gen::Point p) {
+        return 0 <= p.x && p.x <= max_value && 0 <= p.y && p.y <= max_value;
+    });
+}
+
+bool distinct(std::vector<gen::Point> points) {
+    std::sort(points.begin(), points.end());
+    return std::adjacent_find(points.begin(), points.end()) == points.end();
+}
+
+bool no_three_collinear(std::vector<gen::Point> const& p) {
+    for (std::size_t i = 0; i < p.size(); ++i) {
+        for (std::size_t j = i + 1; j < p.size(); ++j) {
+            for (std::size_t k = j + 1; k < p.size(); ++k) {
+                if (gen::cross(p[i], p[j], p[k]) == 0) return false;
+            }
+        }
+    }
+    return true;
+}
+
+int sign(__int128 x) { return (x > 0) - (x < 0); }
+
+bool segments_intersect(gen::Point a, gen::Point b, gen::Point c,
+                        gen::Point d) {
+    return sign(gen::cross(a, b, c)) * sign(gen::cross(a, b, d)) <= 0 &&
+           sign(gen::cross(c, d, a)) * sign(gen::cross(c, d, b)) <= 0;
+}
+
+bool is_simple(std::vector<gen::Point> const& p) {
+    std::size_t n = p.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = i + 2; j < n; ++j) {
+            if (i == 0 && j == n - 1) continue;
+            if (segments_intersect(p[i], p[i + 1], p[j], p[(j + 1) % n])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+__int128 twice_area(std::vector<gen::Point> const& p) {
+    __int128 area = 0;
+    for (std::size_t i = 1; i + 1 < p.size(); ++i) {
+        area += gen::cross(p[0], p[i], p[i + 1]);
+    }
+    return area;
+}
+
+TEST(GeometryGeneratorTest, ConvexPolygon_ShouldBeStrictlyConvex) {
+    gen::Random rng(1);
+    for (auto [n, max_value] : std::vector<std::pair<int, long long>>{
+             {3, 2}, {10, 100}, {200, 100000}, {1000, 1000000000}}) {
+        std::vector<gen::Point> p = gen::convex_polygon(rng, n, max_value);
+        ASSERT_EQ(p.size(), n);
+        EXPECT_TRUE(in_range(p, max_value));
+        EXPECT_TRUE(distinct(p));
+        for (int i = 0; i < n; ++i) {
+            ASSERT_GT(gen::cross(p[i], p[(i + 1) % n], p[(i + 2) % n]), 0);
+        }
+        if (n <= 200) {
+            EXPECT_TRUE(is_simple(p));
+        }
+    }
+    EXPECT_THROW(gen::convex_polygon(rng, 1000, 1000),
+                 InvalidArgumentException);
+}
+
+TEST(GeometryGeneratorTest, NoThreeCollinear_ShouldHaveNoCollinearTriples) {
+    gen::Random rng(2);
+    for (long long max_value : {10LL, 200LL, 1000000000LL}) {
+        std::vector<gen::Point> p = gen::no_three_collinear(rng, 11, max_value);
+        EXPECT_TRUE(in_range(p, max_value));
+        EXPECT_TRUE(distinct(p));
+        EXPECT_TRUE(no_three_collinear(p));
+    }
+    std::vector<gen::Point> p = gen::no_three_collinear(rng, 200, 1000);
+    EXPECT_TRUE(no_three_collinear(p));
+    EXPECT_THROW(gen::no_three_collinear(rng, 12, 10),
+                 InvalidArgumentException);
+    EXPECT_TRUE(gen::is_prime(1000000007));
+    EXPECT_FALSE(gen::is_prime(3215031751ULL));
+}
+
+TEST(GeometryGeneratorTest, SimplePolygon_ShouldBeSimple) {
+    gen::Random rng(3);
+    for (int n : {3, 4, 10, 300}) {
+        std::vector<gen::Point> p = gen::simple_polygon(rng, n, 1000);
+        ASSERT_EQ(p.size(), n);
+        EXPECT_TRUE(in_range(p, 1000));
+        EXPECT_TRUE(is_simple(p));
+        EXPECT_GT(twice_area(p), 0);
+    }
+}
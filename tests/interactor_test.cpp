@@ -0,0 +1,193 @@
+#include "../src/interactor.hpp"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cplib;
+
+interact::Task guess_the_number(interact::Session& s, int secret) {
+    io::Reader& r = s.reader();
+    io::Writer& w = s.writer();
+    for (int queries = 0; queries < 20; ++queries) {
+        co_await s.read_line();
+        int x = r.read_integer<int>(1, 1000000);
+        if (x == secret) {
+            w << "=\n";
+            co_await s.flush();
+            co_return;
+        }
+        w << (x < secret ? "<\n" : ">\n");
+        co_await s.flush();
+    }
+    throw chk::WrongAnswerException("Too many queries");
+}
+
+interact::Task write_only(interact::Session& s, std::size_t size) {
+    s.writer() << std::string(size, 'x');
+    co_return;
+}
+
+// Plays the game with blocking I/O, making at most max_queries queries.
+void solution(int read_fd, int write_fd, bool linear_search) {
+    FILE* in = fdopen(read_fd, "r");
+    FILE* out = fdopen(write_fd, "w");
+    int low = 1, high = 1000000;
+    char answer[4];
+    do {
+        int x = linear_search ? low : (low + high) / 2;
+        fprintf(out, "%d\n", x);
+        fflush(out);
+        if (fscanf(in, "%3s", answer) != 1) break;
+        if (answer[0] == '<') low = x + 1;
+        if (answer[0] == '>') high = x - 1;
+    } while (answer[0] != '=');
+    fclose(in);
+    fclose(out);
+}
+
+class InteractorTest : public testing::Test {
+   protected:
+    interact::Engine engine;
+    std::vector<std::thread> solutions;
+
+    interact::Session& add_session(int secret, bool linear_search) {
+        int to_interactor[2], to_solution[2];
+        EXPECT_EQ(pipe(to_interactor), 0);
+        EXPECT_EQ(pipe(to_solution), 0);
+        solutions.emplace_back(solution, to_solution[0], to_interactor[1],
+                               linear_search);
+        return engine.add(to_interactor[0], to_solution[1],
+                          [secret](interact::Session& s) {
+                              return guess_the_number(s, secret);
+                          });
+    }
+
+    void TearDown() override {
+        for (std::thread& t : solutions) t.join();
+    }
+};
+
+TEST_F(InteractorTest, Run_WithManySessions_ShouldJudgeAll) {
+    std::vector<interact::Session*> sessions;
+    for (int i = 0; i < 100; ++i) {
+        sessions.push_back(&add_session(i * 9973 + 1, i % 10 == 0));
+    }
+    engine.run();
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(sessions[i]->done());
+        chk::Verdict const& verdict = sessions[i]->verdict();
+        EXPECT_FALSE(verdict.error);
+        EXPECT_EQ(verdict.score, i % 10 == 0 && i > 0 ? 0.0 : 1.0)
+            << verdict.message;
+    }
+}
+
+TEST_F(InteractorTest, Run_WhenSolutionExits_ShouldGiveWrongAnswer) {
+    int to_interactor[2], to_solution[2];
+    ASSERT_EQ(pipe(to_interactor), 0);
+    ASSERT_EQ(pipe(to_solution), 0);
+    write(to_interactor[1], "500000\n", 7);
+    close(to_interactor[1]);
+    close(to_solution[0]);
+    interact::Session& s =
+        engine.add(to_interactor[0], to_solution[1],
+                   [](interact::Session& s) { return guess_the_number(s, 1); });
+    engine.run();
+    EXPECT_EQ(s.verdict().score, 0.0);
+    EXPECT_FALSE(s.verdict().error);
+}
+
+TEST_F(InteractorTest, Run_WithRecorder_ShouldRecordTranscripts) {
+    std::string transcript_file = testing::TempDir() + "interactor.bin";
+    {
+        io::TranscriptRecorder recorder(transcript_file.c_str());
+        engine.record_to(recorder);
+        add_session(1000000, false);
+        add_session(1, false);
+        engine.run();
+    }
+    std::vector<std::string> streams(4);
+    for (auto const& entry : io::read_transcript(transcript_file.c_str())) {
+        ASSERT_LT(entry.stream, 4);
+        streams[entry.stream] += entry.data;
+    }
+    EXPECT_EQ(streams[0].substr(0, 14), "500000\n750000\n");
+    EXPECT_EQ(streams[1].substr(0, 4), "<\n<\n");
+    EXPECT_EQ(streams[2].substr(0, 14), "500000\n250000\n");
+    EXPECT_EQ(streams[3].substr(0, 4), ">\n>\n");
+    EXPECT_EQ(streams[3].substr(streams[3].size() - 2), "=\n");
+}
+
+TEST_F(InteractorTest, Run_WhenInteractorThrows_ShouldGiveErrorToThatSession) {
+    interact::Session& correct = add_session(42, false);
+    int to_interactor[2], to_solution[2];
+    ASSERT_EQ(pipe(to_interactor), 0);
+    ASSERT_EQ(pipe(to_solution), 0);
+    close(to_interactor[1]);
+    close(to_solution[0]);
+    interact::Session& failing = engine.add(
+        to_interactor[0], to_solution[1],
+        [](interact::Session&) -> interact::Task {
+            throw std::runtime_error("Interactor bug");
+            co_return;
+        });
+    engine.run();
+    EXPECT_TRUE(failing.verdict().error);
+    EXPECT_EQ(failing.verdict().message, "Interactor bug");
+    EXPECT_FALSE(correct.verdict().error);
+    EXPECT_EQ(correct.verdict().score, 1.0);
+}
+
+TEST_F(InteractorTest, Run_WhenSessionExpires_ShouldGiveTimeLimitExceeded) {
+    interact::Session& correct = add_session(42, false);
+    int to_interactor[2], to_solution[2];
+    ASSERT_EQ(pipe(to_interactor), 0);
+    ASSERT_EQ(pipe(to_solution), 0);
+    // The solution never writes anything.
+    interact::Session& idle = engine.add(
+        to_interactor[0], to_solution[1],
+        [](interact::Session& s) { return guess_the_number(s, 1); },
+        std::chrono::milliseconds(100));
+    auto start = std::chrono::steady_clock::now();
+    engine.run();
+    EXPECT_LT(std::chrono::steady_clock::now() - start,
+              std::chrono::seconds(2));
+    EXPECT_EQ(idle.verdict().score, 0.0);
+    EXPECT_FALSE(idle.verdict().error);
+    EXPECT_EQ(idle.verdict().message, "Time limit exceeded");
+    EXPECT_EQ(correct.verdict().score, 1.0);
+    close(to_interactor[1]);
+    close(to_solution[0]);
+}
+
+TEST_F(InteractorTest, Run_WhenInteractorReturns_ShouldSendAllItsOutput) {
+    int to_interactor[2], to_solution[2];
+    ASSERT_EQ(pipe(to_interactor), 0);
+    ASSERT_EQ(pipe(to_solution), 0);
+    close(to_interactor[1]);
+    // Much more than fits in the pipe, never flushed.
+    std::size_t size = 1 << 20;
+    std::size_t received = 0;
+    solutions.emplace_back([&received, fd = to_solution[0]]() {
+        char buffer[4096];
+        ssize_t n;
+        while ((n = read(fd, buffer, sizeof(buffer))) > 0) received += n;
+        close(fd);
+    });
+    interact::Session& s = engine.add(
+        to_interactor[0], to_solution[1],
+        [size](interact::Session& s) { return write_only(s, size); });
+    engine.run();
+    solutions.back().join();
+    solutions.pop_back();
+    EXPECT_EQ(received, size);
+    EXPECT_EQ(s.verdict().score, 1.0);
+    EXPECT_EQ(s.verdict().message, "Output is correct");
+}
@@ -0,0 +1,108 @@
+#include "../src/interning.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../src/validation.hpp"
+
+using namespace cplib;
+
+TEST(StringInternerTest, AssignsDenseIds) {
+    StringInterner interner;
+    EXPECT_EQ(interner.find("a"), StringInterner::npos);
+    EXPECT_EQ(interner.intern("alice"), 0u);
+    EXPECT_EQ(interner.intern("bob"), 1u);
+    EXPECT_EQ(interner.intern(""), 2u);
+    EXPECT_EQ(interner.intern("alice"), 0u);
+    EXPECT_EQ(interner.intern(std::string("bob")), 1u);
+    EXPECT_EQ(interner.size(), 3u);
+    EXPECT_EQ(interner.find(""), 2u);
+    EXPECT_EQ(interner.find("carol"), StringInterner::npos);
+    EXPECT_EQ(interner.get(0), "alice");
+    EXPECT_EQ(interner.get(2), "");
+
+    interner.clear();
+    EXPECT_EQ(interner.size(), 0u);
+    EXPECT_EQ(interner.find("alice"), StringInterner::npos);
+    EXPECT_EQ(interner.intern("bob"), 0u);
+}
+
+TEST(StringInternerTest, ManyStrings) {
+    StringInterner interner(42);
+    const int N = 100000;
+    for (int i = 0; i < N; ++i) {
+        EXPECT_EQ(interner.intern("name" + std::to_string(i)),
+                  static_cast<std::size_t>(i));
+    }
+    for (int i = N - 1; i >= 0; --i) {
+        ASSERT_EQ(interner.find("name" + std::to_string(i)),
+                  static_cast<std::size_t>(i));
+        ASSERT_EQ(interner.get(i), "name" + std::to_string(i));
+    }
+    EXPECT_EQ(interner.find("name" + std::to_string(N)),
+              StringInterner::npos);
+}
+
+TEST(StringInternerTest, DistinctStrings) {
+    std::vector<std::string> v = {"b", "abc", "", "ab", "c"};
+    EXPECT_TRUE(val::distinct(v));
+    v.push_back("ab");
+    EXPECT_EQ(val::distinct(v).message(),
+              "Elements are not distinct: Multiple occurrences of \"ab\"");
+    EXPECT_FALSE(val::distinct(std::vector<std::string>{"", ""}));
+    EXPECT_TRUE(val::distinct(std::vector<std::string>{}));
+}
+
+std::uint64_t unshift(std::uint64_t y, int shift) {
+    std::uint64_t x = y;
+    for (int i = 0; i < 64 / shift; ++i) {
+        x = y ^ (x >> shift);
+    }
+    return x;
+}
+
+std::uint64_t inverse(std::uint64_t m) {
+    std::uint64_t x = m;
+    for (int i = 0; i < 6; ++i) {
+        x *= 2 - m * x;
+    }
+    return x;
+}
+
+std::uint64_t unmix64(std::uint64_t x) {
+    x = unshift(x, 31) * inverse(0x94d049bb133111ebULL);
+    x = unshift(x, 27) * inverse(0xbf58476d1ce4e5b9ULL);
+    return unshift(x, 30) - 0x9e3779b97f4a7c15ULL;
+}
+
+// Distinct 16-byte strings with the same hash under the key of seed 0: the
+// second word cancels out the hash of the first.
+std::vector<std::string> colliding_strings(std::size_t n) {
+    std::uint64_t key = mix64(0);
+    std::vector<std::string> v;
+    for (std::uint64_t w1 = 0; w1 < n; ++w1) {
+        std::uint64_t w2 = unmix64(42) ^ mix64((key ^ 16) ^ w1);
+        std::string s(16, '\0');
+        std::memcpy(s.data(), &w1, 8);
+        std::memcpy(s.data() + 8, &w2, 8);
+        v.push_back(s);
+    }
+    return v;
+}
+
+TEST(StringInternerTest, DistinctAdversarialStrings) {
+    std::vector<std::string> v = colliding_strings(40000);
+    StringInterner fixed(0);
+    for (std::size_t i = 0; i < 1000; ++i) {
+        fixed.intern(v[i]);
+    }
+    EXPECT_EQ(fixed.max_probe_length(), 999u);
+
+    EXPECT_TRUE(val::distinct(v));
+    v.push_back(v[12345]);
+    EXPECT_FALSE(val::distinct(v));
+}
@@ -1,7 +1,9 @@
 #include "../src/io.hpp"
 
 #include <gtest/gtest.h>
+#include <unistd.h>
 
+#include <cstring>
 #include <iostream>
 #include <set>
 #include <string>
@@ -317,6 +319,56 @@ TEST_F(ReaderTestStrict, ReadIntegers) {
                  io::UnexpectedReadException);
 }
 
+TEST_F(ReaderTestStrict, Rebind_KeepsConfiguration) {
+    std::string path = testing::TempDir() + "/io_test_rebind.in";
+    io::Writer(path.c_str()).write_string("007 1,5\n");
+    reader.with_leading_zeros().with_comma_as_decimal_separator();
+
+    for (int i = 0; i < 3; ++i) {
+        reader.rebind(path);
+        EXPECT_EQ(reader.read_integer<int>(), 7);
+        reader.must_be_space();
+        EXPECT_EQ(reader.read_floating_point<double>(), 1.5);
+        reader.must_be_newline();
+        EXPECT_NO_THROW(reader.must_be_eof());
+
+        std::string input = "1  2\n";
+        reader.rebind_view(input);
+        EXPECT_EQ(reader.read_integer<int>(), 1);
+        reader.must_be_space();
+        EXPECT_THROW(reader.read_integer<int>(), io::UnexpectedReadException);
+    }
+
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    ASSERT_EQ(write(fds[1], "-5\n", 3), 3);
+    close(fds[1]);
+    reader.rebind(fds[0]);
+    EXPECT_EQ(reader.read_integer<int>(), -5);
+    reader.must_be_newline();
+    EXPECT_NO_THROW(reader.must_be_eof());
+    close(fds[0]);
+
+    reader.reset();
+    EXPECT_TRUE(reader.is_eof());
+    EXPECT_THROW(reader.rebind("/nonexistent/io_test.in"),
+                 io::OpenFailureException);
+    EXPECT_THROW(reader.read_char(), io::EOFException);
+}
+
+TEST(ReaderTest, Reset_WhenConstructedFromFile) {
+    std::string path = testing::TempDir() + "/io_test_reset.in";
+    io::Writer(path.c_str()).write_string("1 2\n");
+    io::Reader reader(path.c_str(), true);
+    EXPECT_EQ(reader.read_integer<int>(), 1);
+    reader.reset();
+    EXPECT_TRUE(reader.is_eof());
+    EXPECT_THROW(reader.read_char(), io::EOFException);
+    reader.rebind(path.c_str());
+    EXPECT_EQ(reader.read_integer<int>(), 1);
+    EXPECT_THROW(reader.read_integer<int>(), io::UnexpectedReadException);
+}
+
 class WriterTest : public testing::Test {
    protected:
     std::ostringstream* ss;
@@ -409,3 +461,79 @@ TEST_F(WriterTest, StreamOperator) {
 
     EXPECT_EQ(ss->str(), expected);
 }
+
+TEST(ExceptionTest, Messages) {
+    EXPECT_STREQ(io::EOFException().what(), "Reached EOF");
+    EXPECT_STREQ(io::UnexpectedReadException('x').what(),
+                 "Encountered character 'x'");
+    EXPECT_STREQ(io::UnexpectedReadException::expected("newline").what(),
+                 "Expected newline");
+    EXPECT_STREQ(io::UnexpectedReadException("'" + std::string("abc") + "'")
+                     .what(),
+                 "Expected 'abc'");
+    EXPECT_STREQ(io::OverflowException(Limits<long long>::MAX).what(),
+                 "Exceeded limit 9223372036854775807");
+    EXPECT_STREQ(
+        FailedValidationException::interval_constraint("n", -1, 10).what(),
+        "Expected -1 <= n <= 10");
+    EXPECT_STREQ(
+        FailedValidationException::interval_constraint("x", 0.5, 2.0).what(),
+        "Expected 0.500000 <= x <= 2.000000");
+    EXPECT_STREQ(
+        FailedValidationException::interval_constraint("c", '0', 'A').what(),
+        "Expected 48 <= c <= 65");
+    EXPECT_STREQ(FailedValidationException::interval_constraint(
+                     StaticString("k"), 1, 2)
+                     .what(),
+                 "Expected 1 <= k <= 2");
+    std::string name = "len(s)";
+    EXPECT_STREQ(FailedValidationException::interval_constraint(name.c_str(),
+                                                                 1, 3)
+                     .what(),
+                 "Expected 1 <= len(s) <= 3");
+    EXPECT_EQ(FailedValidationException::interval_constraint(
+                  std::string("len(s)"), 1ul, 3ul)
+                  .what_with_line("a.cpp", 7),
+              "FAILED VALIDATION AT a.cpp::7\n---\n"
+              "Expected 1 <= len(s) <= 3\n---");
+}
+
+TEST(ExceptionTest, Names_ShouldBeCopiedUnlessStatic) {
+    char name[8] = "k";
+    auto e = FailedValidationException::interval_constraint(name, 1, 2);
+    std::strcpy(name, "zz");
+    EXPECT_STREQ(e.what(), "Expected 1 <= k <= 2");
+}
+
+TEST(ExceptionTest, Messages_ShouldBeFormattedOnce) {
+    static const char long_text[] =
+        "a description of the expected input much longer than any fixed "
+        "buffer would be, a description of the expected input much longer "
+        "than any fixed buffer would be, a description of the expected "
+        "input much longer than any fixed buffer would be, a description "
+        "of the expected input much longer than any fixed buffer would be";
+    auto e = io::UnexpectedReadException::expected(long_text);
+    const char* message = e.what();
+    EXPECT_EQ(std::string(message), "Expected " + std::string(long_text));
+    // Other messages don't overwrite it.
+    for (int i = 0; i < 10; ++i) {
+        io::OverflowException(i).what();
+    }
+    EXPECT_EQ(e.what(), message);
+    EXPECT_EQ(std::string(message), "Expected " + std::string(long_text));
+}
+
+TEST(ExceptionTest, CopiesKeepTheirMessage) {
+    io::IOException copy("");
+    try {
+        io::Reader reader(*new std::istringstream("12a"));
+        reader.read_integer<int>();
+        reader.must_be_eof();
+    } catch (io::IOException const& e) {
+        copy = e;
+    }
+    std::string message = copy.what();
+    EXPECT_EQ(message, "Expected EOF");
+    io::IOException other = copy;
+    EXPECT_EQ(other.what(), message);
+}
@@ -0,0 +1,166 @@
+#include "../src/minimizer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../src/tree_generator.hpp"
+
+using namespace cplib;
+
+// Sums the array, but the solution counts the 7s twice.
+const std::vector<std::string> SUM = {
+    "awk", "NR == 2 { s = 0; for (i = 1; i <= NF; ++i) s += $i; print s }"};
+const std::vector<std::string> WRONG_SUM = {
+    "awk",
+    "NR == 2 { s = 0; for (i = 1; i <= NF; ++i) s += $i + ($i == 7); "
+    "print s }"};
+
+void gen_array(gen::Random& rng, io::Writer& w) {
+    int n = 1000;
+    std::vector<int> v(n);
+    for (int& x : v) x = rng.next(1, 100);
+    w << n << "\n" << v << "\n";
+}
+
+TEST(MinimizerTest, Minimize_ShouldShrinkArrays) {
+    stress::Harness harness(WRONG_SUM, SUM, gen_array);
+    std::optional<stress::Failure> failure = harness.run(1, 100);
+    ASSERT_TRUE(failure.has_value());
+
+    stress::Format format;
+    format.line();
+    format.array({0, 0});
+    std::string results[2];
+    for (int k = 0; k < 2; ++k) {
+        stress::Failure minimized = stress::Minimizer(harness, format)
+                                        .with_threads(k == 0 ? 1 : 8)
+                                        .minimize(*failure);
+        EXPECT_EQ(minimized.seed, failure->seed);
+        results[k] = minimized.input;
+    }
+    EXPECT_EQ(results[0], "1\n7\n");
+    EXPECT_EQ(results[1], results[0]);
+}
+
+TEST(MinimizerTest, Minimize_ShouldKeepTheKindOfFailure) {
+    // The brute force only accepts arrays of at least 5 elements.
+    const std::vector<std::string> picky_sum = {
+        "awk",
+        "NR == 1 && $1 < 5 { exit 1 } "
+        "NR == 2 { s = 0; for (i = 1; i <= NF; ++i) s += $i; print s }"};
+    stress::Harness harness(WRONG_SUM, picky_sum, gen_array);
+    std::optional<stress::Failure> failure = harness.run(1, 100);
+    ASSERT_TRUE(failure.has_value());
+    EXPECT_EQ(failure->kind, stress::Failure::Kind::MISMATCH);
+
+    stress::Format format;
+    format.line();
+    format.array({0, 0});
+    stress::Failure minimized =
+        stress::Minimizer(harness, format).minimize(*failure);
+    EXPECT_EQ(minimized.kind, stress::Failure::Kind::MISMATCH);
+    EXPECT_EQ(minimized.input.substr(0, 2), "5\n");
+    EXPECT_NE(minimized.input.find('7'), std::string::npos);
+}
+
+// Maximum degree of a tree, but the solution never prints more than 2.
+const std::vector<std::string> MAX_DEGREE = {
+    "awk",
+    "NR > 1 { d[$1]++; d[$2]++ } "
+    "END { m = 0; for (v in d) if (d[v] > m) m = d[v]; print m }"};
+const std::vector<std::string> WRONG_MAX_DEGREE = {
+    "awk",
+    "NR > 1 { d[$1]++; d[$2]++ } "
+    "END { m = 0; for (v in d) if (d[v] > m) m = d[v]; "
+    "print (m > 2 ? 2 : m) }"};
+
+void gen_tree(gen::Random& rng, io::Writer& w) {
+    gen::Tree t = gen::random_tree(rng, 30);
+    w << t.size() << "\n";
+    t.write_edges(w);
+}
+
+void validate_tree(io::Reader& r) {
+    int n = r.read_integer(1, 100);
+    r.must_be_newline();
+    std::vector<int> root(n + 1);
+    for (int v = 1; v <= n; ++v) root[v] = v;
+    auto find = [&root](int v) {
+        while (root[v] != v) v = root[v] = root[root[v]];
+        return v;
+    };
+    for (int i = 0; i < n - 1; ++i) {
+        int u = r.read_integer(1, n);
+        r.must_be_space();
+        int v = r.read_integer(1, n);
+        r.must_be_newline();
+        if (find(u) == find(v)) {
+            throw FailedValidationException("Not a tree");
+        }
+        root[find(u)] = find(v);
+    }
+    r.must_be_eof();
+}
+
+TEST(MinimizerTest, Minimize_ShouldRemoveVerticesFromEdgeLists) {
+    stress::Harness harness(WRONG_MAX_DEGREE, MAX_DEGREE, gen_tree);
+    std::optional<stress::Failure> failure = harness.run(1, 100);
+    ASSERT_TRUE(failure.has_value());
+
+    stress::Format format;
+    format.line();
+    format.rows({0, 0}, -1);
+    format.labels(1, {0, 1}, {0, 0});
+    stress::Failure minimized = stress::Minimizer(harness, format)
+                                    .with_validator(validate_tree)
+                                    .minimize(*failure);
+    EXPECT_EQ(minimized.input.substr(0, 2), "4\n");
+    EXPECT_EQ(minimized.expected_output, "3\n");
+}
+
+// The number of lines of a minimized tree, which must be n.
+std::size_t count_lines(std::string const& input) {
+    return std::count(input.begin(), input.end(), '\n');
+}
+
+TEST(MinimizerTest, Minimize_WithoutValidator_ShouldKeepTheFormat) {
+    stress::Harness harness(WRONG_MAX_DEGREE, MAX_DEGREE, gen_tree);
+    std::optional<stress::Failure> failure = harness.run(1, 100);
+    ASSERT_TRUE(failure.has_value());
+
+    // Without labels, removing vertices can't remove the edges.
+    stress::Format format;
+    format.line();
+    format.rows({0, 0}, -1);
+    stress::Failure minimized =
+        stress::Minimizer(harness, format).minimize(*failure);
+    EXPECT_EQ(minimized.input.substr(0, 3), "30\n");
+    EXPECT_EQ(count_lines(minimized.input), 30);
+
+    // With labels, only leaves can be removed.
+    format.labels(1, {0, 1}, {0, 0});
+    minimized = stress::Minimizer(harness, format).minimize(*failure);
+    EXPECT_EQ(minimized.input.substr(0, 2), "4\n");
+    EXPECT_EQ(count_lines(minimized.input), 4);
+}
+
+TEST(MinimizerTest, Minimize_WithoutFormat_ShouldShrinkNumbers) {
+    auto gen_number = [](gen::Random& rng, io::Writer& w) {
+        w << rng.next(1000, 2000) << "\n";
+    };
+    // Wrong for numbers greater than 100.
+    stress::Harness harness({"awk", "{ print ($1 > 100) }"},
+                            {"awk", "{ print 0 }"}, gen_number);
+    std::optional<stress::Failure> failure = harness.run(1, 1);
+    ASSERT_TRUE(failure.has_value());
+    EXPECT_EQ(stress::Minimizer(harness).minimize(*failure).input, "101\n");
+
+    stress::Format format;
+    format.line();
+    format.array({0, 0});
+    EXPECT_THROW(stress::Minimizer(harness, format).minimize(*failure),
+                 InvalidArgumentException);
+}
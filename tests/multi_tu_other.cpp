@@ -0,0 +1,29 @@
+// The second translation unit of multi_tu_test. Every header is included in
+// both, so that a non-inline definition in a header fails to link.
+#include "../src/benchmark_corpus.hpp"
+#include "../src/checker.hpp"
+#include "../src/checker_service.hpp"
+#include "../src/common.hpp"
+#include "../src/generator.hpp"
+#include "../src/geometry_generator.hpp"
+#include "../src/interactor.hpp"
+#include "../src/interning.hpp"
+#include "../src/io.hpp"
+#include "../src/minimizer.hpp"
+#include "../src/process.hpp"
+#include "../src/profiling.hpp"
+#include "../src/scoped_timer.hpp"
+#include "../src/shared_input.hpp"
+#include "../src/stress.hpp"
+#include "../src/string_generator.hpp"
+#include "../src/thread_pool.hpp"
+#include "../src/timing.hpp"
+#include "../src/transcript.hpp"
+#include "../src/tree_generator.hpp"
+#include "../src/validation.hpp"
+
+namespace multi_tu {
+
+std::string other_unit() { return cplib::to_string(42); }
+
+}  // namespace multi_tu
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/benchmark_corpus.hpp"
+#include "../src/io.hpp"
+#include "../src/validation.hpp"
+
+using namespace cplib;
+
+// Throughput of each benchmark relative to the calibration loop (memchr and
+// memcpy over the same amount of memory), as measured with g++ -O2 on x86-64.
+// To update them after an intentional change, run the test with
+// CPLIB_PERF_MARGIN=1 (which never fails) and copy the printed ratios.
+const std::vector<std::pair<std::string, double>> BASELINES = {
+    {"integer_parse", 0.0095}, {"float_parse", 0.0019},
+    {"strict_validation", 0.0025}, {"writer", 0.0240},
+    {"distinct", 0.0100},
+};
+
+// A benchmark fails if its ratio is below (1 - margin) times the baseline.
+// Taking the best of many runs keeps the noise to about 20% on a quiet
+// machine, so the default leaves room for a loaded one: a tighter margin
+// (e.g. CPLIB_PERF_MARGIN=0.25) is opt-in, for dedicated machines. Set a
+// larger one on machines whose ratios differ from these.
+double margin() {
+    const char* value = std::getenv("CPLIB_PERF_MARGIN");
+    return value != nullptr ? std::atof(value) : 0.5;
+}
+
+template <class T>
+void do_not_optimize(T const& x) {
+    asm volatile("" : : "r"(&x) : "memory");
+}
+
+// Best throughput of f over many runs, in MB/s: the noise (interrupts,
+// frequency scaling, other processes) only ever makes a run slower. f returns
+// the seconds spent on the measured part of the run.
+template <class F>
+double throughput(std::size_t bytes, F f, int repetitions = 15) {
+    double best = f();
+    for (int i = 1; i < repetitions; ++i) best = std::min(best, f());
+    return bytes / best / 1e6;
+}
+
+template <class F>
+double timed(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+}
+
+class PerformanceTest : public testing::Test {
+   protected:
+    static constexpr std::size_t SIZE = 8 << 20;
+
+    static double calibration;
+
+    static void SetUpTestSuite() {
+        // The loop is cheap but noisy, being bound by memory bandwidth.
+        std::string src(SIZE, 'a'), dst(SIZE, '\0');
+        calibration = throughput(
+            SIZE,
+            [&]() {
+                return timed([&]() {
+                    do_not_optimize(std::memchr(src.data(), 'b', SIZE));
+                    std::memcpy(dst.data(), src.data(), SIZE);
+                    do_not_optimize(dst);
+                });
+            },
+            200);
+    }
+
+    static std::string corpus(bench::Corpus corpus) {
+        auto* ss = new std::ostringstream();
+        io::Writer w(*ss);
+        bench::write_corpus(w, corpus, SIZE, 0);
+        return ss->str();
+    }
+
+    void SetUp() override {
+#if !defined(__OPTIMIZE__)
+        GTEST_SKIP() << "Performance is only meaningful in optimized builds";
+#endif
+    }
+
+    void check(std::string const& name, double mb_per_second) {
+        double ratio = mb_per_second / calibration;
+        auto it = std::find_if(
+            BASELINES.begin(), BASELINES.end(),
+            [&name](auto const& baseline) { return baseline.first == name; });
+        ASSERT_NE(it, BASELINES.end());
+        std::printf("%-20s %9.1f MB/s  ratio %.5f  baseline %.5f\n",
+                    name.c_str(), mb_per_second, ratio, it->second);
+        RecordProperty(name + "_ratio", std::to_string(ratio));
+        EXPECT_GE(ratio, it->second * (1 - margin()))
+            << name << " regressed: " << mb_per_second << " MB/s";
+    }
+};
+
+double PerformanceTest::calibration;
+
+TEST_F(PerformanceTest, IntegerParse) {
+    std::string input = corpus(bench::Corpus::INT64);
+    check("integer_parse", throughput(input.size(), [&]() {
+              auto* ss = new std::istringstream(input);
+              io::Reader r(*ss);
+              return timed([&]() {
+                  std::size_t n = r.read_integer<std::size_t>();
+                  do_not_optimize(r.read_n_integers<long long>(n));
+              });
+          }));
+}
+
+TEST_F(PerformanceTest, FloatParse) {
+    std::string input = corpus(bench::Corpus::FLOATS);
+    check("float_parse", throughput(input.size(), [&]() {
+              auto* ss = new std::istringstream(input);
+              io::Reader r(*ss);
+              return timed([&]() {
+                  std::size_t n = r.read_integer<std::size_t>();
+                  do_not_optimize(r.read_n_floating_point<double>(n));
+              });
+          }));
+}
+
+TEST_F(PerformanceTest, StrictValidation) {
+    std::string input = corpus(bench::Corpus::SMALL_INTEGERS);
+    check("strict_validation", throughput(input.size(), [&]() {
+              auto* ss = new std::istringstream(input);
+              io::Reader r(*ss, true);
+              return timed([&]() {
+                  std::size_t n = r.read_integer<std::size_t>(1, SIZE);
+                  r.must_be_newline();
+                  std::vector<int> v = r.read_n_integers<int>(n, 0, 99, " ");
+                  r.must_be_newline();
+                  r.must_be_eof();
+                  do_not_optimize(v);
+              });
+          }));
+}
+
+TEST_F(PerformanceTest, Writer) {
+    static constexpr int N = 1 << 20;
+    std::size_t bytes = 0;
+    double mb_per_second = throughput(1, [&]() {
+        auto* ss = new std::ostringstream();
+        io::Writer w(*ss);
+        double seconds = timed([&]() {
+            for (int i = 0; i < N; ++i) {
+                w.write_integer(i * 2654435761u);
+                w.write_space();
+            }
+            // Everything counted below must be written within the
+            // measurement.
+            ss->flush();
+        });
+        bytes = ss->str().size();
+        return seconds;
+    });
+    check("writer", mb_per_second * bytes);
+}
+
+TEST_F(PerformanceTest, Distinct) {
+    static constexpr std::size_t N = 1 << 20;
+    gen::Random rng(0);
+    std::vector<long long> v(N);
+    for (long long& x : v) x = rng();
+    check("distinct", throughput(N * sizeof(long long), [&]() {
+              return timed([&]() { do_not_optimize(val::distinct(v)); });
+          }));
+}
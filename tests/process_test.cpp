@@ -0,0 +1,82 @@
+#include "../src/process.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace cplib;
+
+TEST(ProcessTest, RunProcess_ShouldPipeInputAndOutput) {
+    std::string input(3 << 20, 'x');
+    input += "\n";
+    ProcessResult result = run_process({"cat"}, input);
+    EXPECT_TRUE(result.success());
+    EXPECT_EQ(result.output, input);
+
+    result = run_process({"sh", "-c", "echo hello; echo error >&2"}, "");
+    EXPECT_TRUE(result.success());
+    EXPECT_EQ(result.output, "hello\n");
+}
+
+TEST(ProcessTest, RunProcess_ShouldReportFailures) {
+    ProcessResult result = run_process({"sh", "-c", "exit 3"}, "ignored");
+    EXPECT_FALSE(result.success());
+    EXPECT_EQ(result.describe(), "Exited with status 3");
+
+    result = run_process({"sh", "-c", "kill -9 $$"}, "");
+    EXPECT_FALSE(result.success());
+    EXPECT_EQ(result.describe().rfind("Killed by signal 9", 0), 0);
+
+    result = run_process({"sleep", "5"}, "", std::chrono::milliseconds(100));
+    EXPECT_TRUE(result.timed_out);
+    EXPECT_EQ(result.describe(), "Time limit exceeded");
+
+    // The deadline still holds once the output is closed.
+    auto start = std::chrono::steady_clock::now();
+    result = run_process({"sh", "-c", "exec >&-; sleep 5"}, "",
+                         std::chrono::milliseconds(100));
+    EXPECT_TRUE(result.timed_out);
+    EXPECT_LT(std::chrono::steady_clock::now() - start,
+              std::chrono::seconds(2));
+
+    // Closing the input early must not kill the caller with SIGPIPE.
+    result = run_process({"true"}, std::string(1 << 20, 'x'));
+    EXPECT_TRUE(result.success());
+
+    EXPECT_THROW(run_process({"/nonexistent/program"}, ""), io::IOException);
+}
+
+TEST(ProcessTest, RunProcess_WithOptions_ShouldMeasureResources) {
+    std::string input_file = testing::TempDir() + "process_input.txt";
+    std::ofstream(input_file) << "3 4\n";
+
+    ProcessOptions options;
+    options.input_file = input_file;
+    options.cpu = 0;
+    ProcessResult result =
+        run_process({"awk", "{ print $1 + $2 }"}, "ignored", options);
+    EXPECT_TRUE(result.success());
+    EXPECT_EQ(result.output, "7\n");
+    EXPECT_GT(result.peak_memory, 0);
+
+    options.collect_output = false;
+    result = run_process(
+        {"awk", "BEGIN { for (i = 0; i < 3000000; ++i) s += i; print s }"},
+        "", options);
+    EXPECT_TRUE(result.success());
+    EXPECT_EQ(result.output, "");
+    EXPECT_GT(result.cpu_time.count(), 0);
+    EXPECT_GE(result.wall_time.count(), result.cpu_time.count() / 2);
+}
+
+TEST(ProcessTest, RunProcess_ShouldNotReportThePeakMemoryOfTheCaller) {
+    std::vector<char> ballast(512 << 20, 1);
+    ProcessResult result = run_process({"true"}, "");
+    EXPECT_TRUE(result.success());
+    EXPECT_GT(result.peak_memory, 0);
+    EXPECT_LT(result.peak_memory, std::size_t(64) << 20);
+    EXPECT_EQ(ballast.back(), 1);
+}
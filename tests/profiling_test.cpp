@@ -0,0 +1,73 @@
+#define CPLIB_PROFILE
+
+#include "../src/profiling.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/io.hpp"
+#include "../src/validation.hpp"
+
+using namespace cplib;
+
+class ProfilingTest : public testing::Test {
+   protected:
+    void SetUp() override { prof::Profile::global().clear(); }
+    void TearDown() override { prof::Profile::global().clear(); }
+};
+
+TEST_F(ProfilingTest, Region_ShouldAggregateAcrossThreads) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([]() {
+            for (int i = 0; i < 10; ++i) {
+                prof::Region outer("outer");
+                prof::Region inner("inner");
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    auto regions = prof::Profile::global().get();
+    ASSERT_EQ(regions.size(), 2);
+    EXPECT_EQ(regions["outer"].calls, 40);
+    EXPECT_EQ(regions["inner"].calls, 40);
+    EXPECT_GE(regions["outer"].time, regions["inner"].time);
+    prof::CounterGroup const& group = prof::CounterGroup::of_this_thread();
+    for (int c = 0; c < prof::N_COUNTERS; ++c) {
+        EXPECT_EQ(regions["outer"].counted[c],
+                  group.available(static_cast<prof::Counter>(c)));
+    }
+}
+
+TEST_F(ProfilingTest, Library_ShouldBeInstrumented) {
+    io::Reader r(*new std::istringstream("3 1 2\n"), true);
+    std::vector<int> v = r.read_n_integers<int>(3, " ");
+    EXPECT_TRUE(val::distinct(v).success());
+    EXPECT_TRUE(val::all_between(v, 1, 3).success());
+
+    auto regions = prof::Profile::global().get();
+    EXPECT_EQ(regions["Reader::read_n_integers"].calls, 1);
+    EXPECT_EQ(regions["val::distinct"].calls, 1);
+    EXPECT_EQ(regions["val::all"].calls, 1);
+}
+
+TEST_F(ProfilingTest, Write_ShouldPrintATable) {
+    { prof::Region region("some_region"); }
+    std::ostringstream out;
+    prof::Profile::global().write(out);
+    std::istringstream lines(out.str());
+    std::string header, line, name;
+    std::getline(lines, header);
+    EXPECT_EQ(header.substr(0, 6), "region");
+    EXPECT_NE(header.find("ipc"), std::string::npos);
+    std::getline(lines, line);
+    std::uint64_t calls;
+    std::istringstream(line) >> name >> calls;
+    EXPECT_EQ(name, "some_region");
+    EXPECT_EQ(calls, 1);
+}
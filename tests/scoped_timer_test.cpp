@@ -0,0 +1,103 @@
+#include "../src/scoped_timer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cplib;
+
+class ScopedTimerTest : public testing::Test {
+   protected:
+    void SetUp() override { prof::TimerReport::reset(); }
+    void TearDown() override { prof::TimerReport::reset(); }
+};
+
+void validate() {
+    {
+        prof::ScopedTimer timer("read header");
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    prof::ScopedTimer timer("read edges");
+    for (int i = 0; i < 3; ++i) {
+        prof::ScopedTimer timer("check tree");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST_F(ScopedTimerTest, Collect_ShouldAggregateNestedPhases) {
+    validate();
+    validate();
+
+    prof::TimerReport report = prof::TimerReport::collect();
+    ASSERT_EQ(report.children.size(), 2);
+    prof::TimerReport const* header = report.child("read header");
+    prof::TimerReport const* edges = report.child("read edges");
+    ASSERT_NE(header, nullptr);
+    ASSERT_NE(edges, nullptr);
+    EXPECT_EQ(header->calls, 2);
+    EXPECT_GE(header->total, 4e-3);
+    EXPECT_EQ(header->total, header->self);
+    EXPECT_EQ(edges->calls, 2);
+    prof::TimerReport const* check = edges->child("check tree");
+    ASSERT_NE(check, nullptr);
+    EXPECT_EQ(check->calls, 6);
+    EXPECT_GE(check->total, 6e-3);
+    EXPECT_NEAR(edges->self, edges->total - check->total, 1e-9);
+    EXPECT_LT(check->total, edges->total);
+    EXPECT_NEAR(report.total, header->total + edges->total, 1e-9);
+}
+
+TEST_F(ScopedTimerTest, Collect_ShouldMergeThreads) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back(validate);
+    }
+    for (std::thread& thread : threads) thread.join();
+    validate();
+
+    prof::TimerReport report = prof::TimerReport::collect();
+    ASSERT_NE(report.child("read edges"), nullptr);
+    EXPECT_EQ(report.child("read edges")->calls, 5);
+    EXPECT_EQ(report.child("read edges")->child("check tree")->calls, 15);
+}
+
+TEST_F(ScopedTimerTest, Write_ShouldIndentNestedPhases) {
+    validate();
+    std::string out;
+    {
+        auto* ss = new std::ostringstream();
+        io::Writer w(*ss);
+        prof::TimerReport::collect().write(w);
+        out = ss->str();
+    }
+    std::istringstream lines(out);
+    std::string line;
+    std::getline(lines, line);
+    EXPECT_EQ(line.substr(0, 18), "read header calls ");
+    std::getline(lines, line);
+    EXPECT_EQ(line.substr(0, 17), "read edges calls ");
+    std::getline(lines, line);
+    EXPECT_EQ(line.substr(0, 19), "  check tree calls ");
+    EXPECT_NE(line.find(" total_ms "), std::string::npos);
+    EXPECT_NE(line.find(" self_ms "), std::string::npos);
+    EXPECT_FALSE(std::getline(lines, line));
+}
+
+TEST(ScopedTimerBenchmark, ShouldBeCheap) {
+    prof::TimerReport::reset();
+    static constexpr int N = 1000000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; ++i) {
+        prof::ScopedTimer timer("phase");
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(prof::TimerReport::collect().child("phase")->calls, N);
+    // Generous bound, to be robust to slow machines and sanitizers.
+    EXPECT_LT(elapsed.count() / N, 1e-6);
+    prof::TimerReport::reset();
+}
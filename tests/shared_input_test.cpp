@@ -0,0 +1,115 @@
+#include "../src/shared_input.hpp"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace cplib;
+
+class SharedInputTest : public testing::Test {
+   protected:
+    std::string input_file = testing::TempDir() + "shared_input.txt";
+    std::string schema = "test-" + std::to_string(getpid());
+    int parsed = 0;
+
+    io::ColumnarInput load() {
+        return io::load_shared(input_file.c_str(), schema,
+                               [this](io::Reader& r, io::ColumnarInput& in) {
+                                   ++parsed;
+                                   int n = r.read<int>();
+                                   in.add_scalar(n);
+                                   in.add(r.read_n_integers<long long>(n));
+                                   in.add(r.read_string());
+                               });
+    }
+
+    void SetUp() override {
+        std::ofstream(input_file) << "4\n10 -20 30000000000 40\nhello\n";
+        io::unlink_shared(input_file.c_str(), schema);
+    }
+
+    void TearDown() override {
+        io::unlink_shared(input_file.c_str(), schema);
+    }
+};
+
+TEST_F(SharedInputTest, LoadShared_ShouldParseOnlyOnce) {
+    io::ColumnarInput first = load();
+    EXPECT_FALSE(first.is_shared());
+    io::ColumnarInput second = load();
+    EXPECT_TRUE(second.is_shared());
+    EXPECT_EQ(parsed, 1);
+
+    for (io::ColumnarInput const* in : {&first, &second}) {
+        ASSERT_EQ(in->size(), 3);
+        EXPECT_EQ(in->get_scalar<int>(0), 4);
+        auto v = in->get<long long>(1);
+        EXPECT_EQ(std::vector<long long>(v.begin(), v.end()),
+                  std::vector<long long>({10, -20, 30000000000, 40}));
+        auto s = in->get<char>(2);
+        EXPECT_EQ(std::string(s.begin(), s.end()), "hello");
+    }
+
+    EXPECT_THROW(second.get<int>(1), InvalidArgumentException);
+    EXPECT_THROW(second.get<int>(3), InvalidArgumentException);
+}
+
+TEST_F(SharedInputTest, LoadShared_WhenContentChanges_ShouldParseAgain) {
+    load();
+    std::ofstream(input_file) << "1\n7\nbye\n";
+    io::ColumnarInput in = load();
+    EXPECT_EQ(parsed, 2);
+    EXPECT_EQ(in.get<long long>(1)[0], 7);
+}
+
+TEST_F(SharedInputTest, LoadShared_WithCorruptedSegment_ShouldFallBack) {
+    std::string name =
+        io::shared_segment_name(io::hash_file(input_file.c_str()), schema);
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    ASSERT_GE(fd, 0);
+    std::string garbage(4096, 'x');
+    ASSERT_EQ(write(fd, garbage.data(), garbage.size()), 4096);
+    close(fd);
+
+    io::ColumnarInput in = load();
+    EXPECT_FALSE(in.is_shared());
+    EXPECT_EQ(parsed, 1);
+    EXPECT_EQ(in.get_scalar<int>(0), 4);
+}
+
+TEST_F(SharedInputTest, Publish_ShouldOnlyShareWithTheOwner) {
+    load();
+    std::string name =
+        io::shared_segment_name(io::hash_file(input_file.c_str()), schema);
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    ASSERT_GE(fd, 0);
+    struct stat st;
+    ASSERT_EQ(fstat(fd, &st), 0);
+    EXPECT_EQ(st.st_mode & 0777, 0600);
+
+    // Only root can give the segment away, as if another user planted it.
+    if (geteuid() == 0) {
+        ASSERT_EQ(fchown(fd, 65534, 65534), 0);
+        io::ColumnarInput in = load();
+        EXPECT_FALSE(in.is_shared());
+        EXPECT_EQ(parsed, 2);
+    }
+    close(fd);
+}
+
+TEST(ColumnarInputTest, Add_ShouldAlignColumns) {
+    io::ColumnarInput in;
+    in.add(std::string("abc"));
+    in.add(std::vector<long double>{1.5, 2.5});
+    auto v = in.get<long double>(1);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(v.data()) % alignof(long double),
+              0);
+    EXPECT_EQ(v[1], 2.5);
+}
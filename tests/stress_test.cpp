@@ -0,0 +1,75 @@
+#include "../src/stress.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace cplib;
+
+void gen_number(gen::Random& rng, io::Writer& w) {
+    w << rng.next(1, 20) << "\n";
+}
+
+const std::vector<std::string> BRUTE_FORCE = {"sh", "-c",
+                                              "read n; echo $((n * 2))"};
+const std::vector<std::string> SOLUTION = {
+    "sh", "-c", "read n; [ $n -eq 7 ] && echo 15 || echo $((n * 2))"};
+
+TEST(StressTest, Run_ShouldFindTheFirstMismatch) {
+    std::optional<stress::Failure> failures[2];
+    for (int k = 0; k < 2; ++k) {
+        failures[k] = stress::Harness(SOLUTION, BRUTE_FORCE, gen_number)
+                          .with_threads(k == 0 ? 1 : 8)
+                          .run(1000, 500);
+        ASSERT_TRUE(failures[k].has_value());
+        EXPECT_EQ(failures[k]->input, "7\n");
+        EXPECT_EQ(failures[k]->expected_output, "14\n");
+        EXPECT_EQ(failures[k]->output, "15\n");
+    }
+    EXPECT_EQ(failures[0]->seed, failures[1]->seed);
+
+    gen::Random rng(failures[0]->seed);
+    EXPECT_EQ(rng.next(1, 20), 7);
+    for (std::uint64_t seed = 1000; seed < failures[0]->seed; ++seed) {
+        gen::Random other(seed);
+        EXPECT_NE(other.next(1, 20), 7);
+    }
+}
+
+TEST(StressTest, Run_WithoutMismatches_ShouldReturnNothing) {
+    EXPECT_FALSE(stress::Harness(BRUTE_FORCE, BRUTE_FORCE, gen_number)
+                     .run(1, 50)
+                     .has_value());
+
+    std::optional<stress::Failure> failure =
+        stress::Harness({"sh", "-c", "exit 1"}, BRUTE_FORCE, gen_number)
+            .run(1, 50);
+    ASSERT_TRUE(failure.has_value());
+    EXPECT_EQ(failure->message, "Solution: Exited with status 1");
+    EXPECT_EQ(failure->kind, stress::Failure::Kind::SOLUTION_ERROR);
+}
+
+TEST(StressTest, Run_WithCustomChecker_ShouldUseIt) {
+    // Accepts any even number.
+    auto check = [](std::string const&, std::string_view,
+                    std::string_view output) {
+        if (std::stoi(std::string(output)) % 2 != 0) {
+            throw chk::WrongAnswerException("Odd output");
+        }
+    };
+    std::optional<stress::Failure> failure =
+        stress::Harness(SOLUTION, BRUTE_FORCE, gen_number)
+            .with_checker(check)
+            .run(1000, 500);
+    ASSERT_TRUE(failure.has_value());
+    EXPECT_EQ(failure->message, "Odd output");
+    EXPECT_EQ(failure->kind, stress::Failure::Kind::MISMATCH);
+
+    std::string prefix = testing::TempDir() + "stress_failure";
+    failure->save(prefix);
+    std::ifstream log(prefix + ".log");
+    std::string line;
+    std::getline(log, line);
+    EXPECT_EQ(line, "seed " + std::to_string(failure->seed));
+}
@@ -0,0 +1,96 @@
+#include "../src/string_generator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+
+using namespace cplib;
+
+TEST(StringGeneratorTest, RandomString_ShouldBeUniform) {
+    gen::Random rng(1);
+    for (std::string alphabet : {"ab", "abc", "abcdefghijklmnopqrstuvwxyz"}) {
+        std::string s = gen::random_string(rng, 260000, alphabet);
+        std::map<char, int> count;
+        for (char c : s) ++count[c];
+        EXPECT_EQ(count.size(), alphabet.size());
+        for (auto [c, k] : count) {
+            EXPECT_NE(alphabet.find(c), std::string::npos);
+            EXPECT_NEAR(k, 260000.0 / alphabet.size(), 1000);
+        }
+    }
+    EXPECT_THROW(gen::random_string(rng, 10, ""), InvalidArgumentException);
+}
+
+TEST(StringGeneratorTest, WriteRandomString_ShouldWriteAllCharacters) {
+    gen::Random rng(2);
+    std::ostringstream* ss = new std::ostringstream();
+    io::Writer w(*ss);
+    gen::write_random_string(w, rng, 200000, "xyz");
+    std::string s = ss->str();
+    EXPECT_EQ(s.size(), 200000);
+    EXPECT_EQ(s.find_first_not_of("xyz"), std::string::npos);
+}
+
+TEST(StringGeneratorTest, FewDistinctString_ShouldUseExactlyKCharacters) {
+    gen::Random rng(3);
+    for (std::size_t k = 1; k <= 5; ++k) {
+        std::string s = gen::few_distinct_string(rng, 1000, "abcdefghij", k);
+        EXPECT_EQ(s.size(), 1000);
+        EXPECT_EQ(std::set<char>(s.begin(), s.end()).size(), k);
+    }
+    std::string s = gen::few_distinct_string(rng, 3, "abcde", 5);
+    EXPECT_EQ(std::set<char>(s.begin(), s.end()).size(), 3);
+    EXPECT_THROW(gen::few_distinct_string(rng, 10, "aab", 3),
+                 InvalidArgumentException);
+}
+
+TEST(StringGeneratorTest, PeriodicString_ShouldRepeat) {
+    gen::Random rng(4);
+    std::string s = gen::periodic_string(rng, 1001, "ab", 7);
+    EXPECT_EQ(s.size(), 1001);
+    for (std::size_t i = 7; i < s.size(); ++i) {
+        EXPECT_EQ(s[i], s[i - 7]);
+    }
+    EXPECT_EQ(gen::periodic_string(rng, 3, "ab", 7).size(), 3);
+}
+
+TEST(StringGeneratorTest, StructuredWords_ShouldMatchDefinitions) {
+    EXPECT_EQ(gen::fibonacci_word(13), "abaababaabaab");
+    EXPECT_EQ(gen::fibonacci_word(1), "a");
+    EXPECT_EQ(gen::fibonacci_word(0), "");
+    EXPECT_EQ(gen::thue_morse_word(16, '0', '1'), "0110100110010110");
+
+    std::string f = gen::fibonacci_word(100000);
+    std::string g = "a", h = "ab";
+    while (h.size() < f.size()) {
+        g = h + g;
+        std::swap(g, h);
+    }
+    EXPECT_EQ(f, h.substr(0, f.size()));
+}
+
+TEST(StringGeneratorTest, RandomBracketSequence_ShouldBeUniform) {
+    gen::Random rng(5);
+    std::map<std::string, int> count;
+    for (int i = 0; i < 14000; ++i) {
+        std::string s = gen::random_bracket_sequence(rng, 8);
+        int depth = 0;
+        for (char c : s) {
+            depth += c == '(' ? 1 : -1;
+            ASSERT_GE(depth, 0);
+        }
+        ASSERT_EQ(depth, 0);
+        ++count[s];
+    }
+    // There are 14 balanced sequences of length 8.
+    EXPECT_EQ(count.size(), 14);
+    for (auto const& [s, k] : count) {
+        EXPECT_NEAR(k, 1000, 150) << s;
+    }
+    EXPECT_EQ(gen::random_bracket_sequence(rng, 0), "");
+    EXPECT_THROW(gen::random_bracket_sequence(rng, 3),
+                 InvalidArgumentException);
+}
@@ -0,0 +1,79 @@
+#include "../src/timing.hpp"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace cplib;
+
+TEST(DistributionTest, ShouldComputeStatistics) {
+    timing::Distribution d({4, 1, 3, 2});
+    EXPECT_EQ(d.min, 1);
+    EXPECT_EQ(d.max, 4);
+    EXPECT_EQ(d.median, 2.5);
+    EXPECT_EQ(d.mean, 2.5);
+    EXPECT_NEAR(d.stddev, 1.118, 1e-3);
+}
+
+class TimingTest : public testing::Test {
+   protected:
+    std::vector<std::string> tests;
+
+    void SetUp() override {
+        for (int n : {1000, 300000}) {
+            tests.push_back(testing::TempDir() + "timing_" +
+                            std::to_string(n) + ".in");
+            std::ofstream(tests.back()) << n << "\n";
+        }
+    }
+};
+
+const std::vector<std::string> SOLUTION = {
+    "awk", "{ for (i = 0; i < $1; ++i) s += i; print s }"};
+
+TEST_F(TimingTest, Run_ShouldMeasureEveryTest) {
+    for (timing::Mode mode : {timing::Mode::WARM, timing::Mode::COLD}) {
+        timing::Report report = timing::Runner(SOLUTION)
+                                    .with_repetitions(3)
+                                    .with_mode(mode)
+                                    .with_cpu(0)
+                                    .run(tests);
+        ASSERT_EQ(report.tests.size(), 2);
+        EXPECT_TRUE(report.success());
+        for (timing::TestReport const& t : report.tests) {
+            EXPECT_LE(t.cpu_time.min, t.cpu_time.median);
+            EXPECT_LE(t.cpu_time.median, t.cpu_time.max);
+            EXPECT_GT(t.wall_time.max, 0);
+            EXPECT_GT(t.peak_memory, 0);
+        }
+        EXPECT_GE(report.suggested_time_limit, 0.1);
+        EXPECT_GE(report.suggested_time_limit,
+                  2 * report.tests[1].cpu_time.max);
+        EXPECT_EQ(report.suggested_memory_limit % (16 << 20), 0);
+        EXPECT_GE(report.suggested_memory_limit,
+                  2 * report.tests[1].peak_memory);
+    }
+}
+
+TEST_F(TimingTest, Report_ShouldBeWrittenAsATable) {
+    timing::Report report =
+        timing::Runner({"sh", "-c", "exit 1"}).with_repetitions(2).run(tests);
+    EXPECT_FALSE(report.success());
+    EXPECT_EQ(report.tests[0].error, "Exited with status 1");
+
+    std::ostringstream* ss = new std::ostringstream();
+    io::Writer w(*ss);
+    report.write(w);
+    std::istringstream lines(ss->str());
+    std::vector<std::string> fields;
+    for (std::string line; std::getline(lines, line);) {
+        std::istringstream tokens(line);
+        fields.emplace_back();
+        for (std::string token; tokens >> token;) fields.back() = token;
+    }
+    EXPECT_EQ(fields, std::vector<std::string>(
+                          {"status", "FAILED", "FAILED", "0.1", "16"}));
+}
@@ -0,0 +1,110 @@
+#include "../src/transcript.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace cplib;
+
+class TranscriptTest : public testing::Test {
+   protected:
+    std::string transcript_file = testing::TempDir() + "transcript.bin";
+};
+
+TEST_F(TranscriptTest, Record_ShouldPreserveOrderAndContent) {
+    {
+        io::TranscriptRecorder recorder(transcript_file.c_str(), 1024);
+        for (int i = 0; i < 1000; ++i) {
+            std::string s = std::to_string(i);
+            recorder.record(i % 3, s.data(), s.size());
+        }
+        std::string large(5000, 'x');
+        recorder.record(7, large.data(), large.size());
+    }
+
+    auto entries = io::read_transcript(transcript_file.c_str());
+    ASSERT_GE(entries.size(), 1001);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(entries[i].stream, i % 3);
+        EXPECT_EQ(entries[i].data, std::to_string(i));
+        if (i > 0) {
+            EXPECT_GE(entries[i].timestamp, entries[i - 1].timestamp);
+        }
+    }
+    std::string large;
+    for (std::size_t i = 1000; i < entries.size(); ++i) {
+        EXPECT_EQ(entries[i].stream, 7);
+        large += entries[i].data;
+    }
+    EXPECT_EQ(large, std::string(5000, 'x'));
+}
+
+TEST_F(TranscriptTest, RecordingStreams_ShouldRecordReaderAndWriter) {
+    std::istringstream in("3\n1 2 3\n");
+    std::ostringstream out;
+    {
+        io::TranscriptRecorder recorder(transcript_file.c_str());
+        io::Reader reader(*new io::RecordingIStream(in.rdbuf(), recorder, 0));
+        io::Writer writer(*new io::RecordingOStream(out.rdbuf(), recorder, 1));
+
+        int n = reader.read<int>();
+        std::vector<int> v = reader.read_n_integers<int>(n);
+        writer << v[0] + v[1] + v[2] << "\n";
+    }
+    EXPECT_EQ(out.str(), "6\n");
+
+    std::string received, sent;
+    for (auto const& entry : io::read_transcript(transcript_file.c_str())) {
+        (entry.stream == 0 ? received : sent) += entry.data;
+    }
+    EXPECT_EQ(received, "3\n1 2 3\n");
+    EXPECT_EQ(sent, "6\n");
+}
+
+// Hands out one byte at a time and never tells how many are available, like
+// the buffer of std::cin synced with stdio.
+class ByteByByteBuffer : public std::streambuf {
+   private:
+    std::string s;
+    std::size_t i = 0;
+
+   protected:
+    int_type underflow() override {
+        if (i == s.size()) {
+            return traits_type::eof();
+        }
+        setg(&s[i], &s[i], &s[i] + 1);
+        ++i;
+        return traits_type::to_int_type(s[i - 1]);
+    }
+
+   public:
+    explicit ByteByByteBuffer(std::string s) : s(std::move(s)) {}
+};
+
+TEST_F(TranscriptTest, RecordingIStream_ShouldRecordLinesOfUnbufferedSource) {
+    std::string input = "3\n1 2 3\n" + std::string(10000, 'x') + "\nend";
+    ByteByByteBuffer in(input);
+    {
+        io::TranscriptRecorder recorder(transcript_file.c_str());
+        io::Reader reader(*new io::RecordingIStream(&in, recorder, 0));
+        EXPECT_EQ(reader.read<int>(), 3);
+        EXPECT_EQ(reader.read_n_integers<int>(3), std::vector<int>({1, 2, 3}));
+        EXPECT_EQ(reader.read<std::string>(), std::string(10000, 'x'));
+        EXPECT_EQ(reader.read<std::string>(), "end");
+    }
+
+    auto entries = io::read_transcript(transcript_file.c_str());
+    std::vector<std::string> received;
+    for (auto const& entry : entries) {
+        received.push_back(entry.data);
+    }
+    EXPECT_EQ(received, std::vector<std::string>({"3\n", "1 2 3\n",
+                                                  std::string(4096 - 8, 'x'),
+                                                  std::string(4096, 'x'),
+                                                  std::string(1816, 'x') + "\n",
+                                                  "end"}));
+}
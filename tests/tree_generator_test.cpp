@@ -0,0 +1,165 @@
+#include "../src/tree_generator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <queue>
+#include <sstream>
+#include <vector>
+
+using namespace cplib;
+
+std::vector<std::vector<int>> adjacency(gen::Tree const& t) {
+    std::vector<std::vector<int>> adj(t.size());
+    for (auto [u, v] : t.edges()) {
+        adj[u].push_back(v);
+        adj[v].push_back(u);
+    }
+    return adj;
+}
+
+// Distances from `source`, or an empty vector if the graph is disconnected.
+std::vector<int> distances(std::vector<std::vector<int>> const& adj,
+                           int source) {
+    std::vector<int> dist(adj.size(), -1);
+    std::queue<int> q;
+    dist[source] = 0;
+    q.push(source);
+    std::size_t visited = 0;
+    while (!q.empty()) {
+        int u = q.front();
+        q.pop();
+        ++visited;
+        for (int v : adj[u]) {
+            if (dist[v] == -1) {
+                dist[v] = dist[u] + 1;
+                q.push(v);
+            }
+        }
+    }
+    return visited == adj.size() ? dist : std::vector<int>();
+}
+
+int depth(gen::Tree const& t) {
+    auto dist = distances(adjacency(t), t.root());
+    EXPECT_FALSE(dist.empty());
+    return *std::max_element(dist.begin(), dist.end());
+}
+
+int diameter(gen::Tree const& t) {
+    auto adj = adjacency(t);
+    auto dist = distances(adj, 0);
+    EXPECT_FALSE(dist.empty());
+    dist = distances(adj, std::max_element(dist.begin(), dist.end()) -
+                              dist.begin());
+    return *std::max_element(dist.begin(), dist.end());
+}
+
+int max_degree(gen::Tree const& t) {
+    int result = 0;
+    for (auto const& neighbors : adjacency(t)) {
+        result = std::max<int>(result, neighbors.size());
+    }
+    return result;
+}
+
+int leaves(gen::Tree const& t) {
+    int result = 0;
+    for (auto const& neighbors : adjacency(t)) {
+        result += neighbors.size() == 1;
+    }
+    return result;
+}
+
+TEST(TreeGeneratorTest, RandomTree_ShouldBeUniform) {
+    gen::Random rng(1);
+    // There are 3^(3 - 2) = 3 labeled trees on 3 vertices, identified by
+    // their central vertex.
+    int count[3] = {0, 0, 0};
+    for (int i = 0; i < 3000; ++i) {
+        gen::Tree t = gen::random_tree(rng, 3);
+        ASSERT_EQ(diameter(t), 2);
+        auto adj = adjacency(t);
+        for (int v = 0; v < 3; ++v) count[v] += adj[v].size() == 2;
+    }
+    for (int c : count) EXPECT_NEAR(c, 1000, 150);
+    EXPECT_EQ(gen::random_tree(rng, 1).size(), 1);
+    gen::Tree t = gen::random_tree(rng, 100000);
+    EXPECT_FALSE(distances(adjacency(t), t.root()).empty());
+}
+
+TEST(TreeGeneratorTest, ShapeTargets_ShouldBeMet) {
+    gen::Random rng(2);
+    for (int n : {1, 2, 3, 10, 1000}) {
+        for (int d : {0, 1, 2, 5, n - 1}) {
+            if (d < 0 || d >= n || (d == 0 && n > 1)) continue;
+            EXPECT_EQ(depth(gen::random_tree_with_depth(rng, n, d)), d);
+            if (d >= 2 || n == d + 1) {
+                EXPECT_EQ(diameter(gen::random_tree_with_diameter(rng, n, d)),
+                          d);
+            }
+        }
+        for (int k : {2, 3, 10}) {
+            EXPECT_LE(max_degree(gen::random_tree_with_max_degree(rng, n, k)),
+                      k);
+        }
+        for (int l : {2, 3, n - 1}) {
+            if (n >= 3 && l >= 2 && l < n) {
+                EXPECT_EQ(leaves(gen::random_tree_with_leaves(rng, n, l)), l);
+            }
+        }
+        EXPECT_LE(max_degree(gen::random_binary_tree(rng, n)), 3);
+        EXPECT_EQ(depth(gen::broom(n, (n + 1) / 2)), n == 1 ? 0 : (n + 1) / 2);
+    }
+    gen::Tree t = gen::random_tree_with_max_degree(rng, 1000, 2);
+    EXPECT_EQ(diameter(t), 999);
+    EXPECT_THROW(gen::random_tree_with_depth(rng, 5, 5),
+                 InvalidArgumentException);
+    EXPECT_THROW(gen::random_tree_with_diameter(rng, 5, 1),
+                 InvalidArgumentException);
+    EXPECT_THROW(gen::random_tree_with_leaves(rng, 5, 5),
+                 InvalidArgumentException);
+}
+
+TEST(TreeGeneratorTest, RandomBinaryTree_ShouldHaveAtMostTwoChildren) {
+    gen::Random rng(3);
+    gen::Tree t = gen::random_binary_tree(rng, 10000);
+    std::vector<int> children(t.size());
+    for (auto [u, v] : t.edges()) ++children[u];
+    EXPECT_LE(*std::max_element(children.begin(), children.end()), 2);
+    EXPECT_EQ(t.root(), 0);
+    EXPECT_FALSE(distances(adjacency(t), 0).empty());
+}
+
+TEST(TreeGeneratorTest, Relabel_ShouldPreserveShape) {
+    gen::Random rng(4);
+    gen::Tree t = gen::caterpillar(rng, 1000, 100);
+    int d = diameter(t), l = leaves(t);
+    t.relabel(rng);
+    EXPECT_EQ(diameter(t), d);
+    EXPECT_EQ(leaves(t), l);
+    EXPECT_EQ(t.parent(t.root()), -1);
+    EXPECT_NE(t.root(), 0);
+
+    // Edges are oriented at random, as written.
+    int child_first = 0;
+    for (auto [u, v] : t.edges()) {
+        EXPECT_TRUE(t.parent(u) == v || t.parent(v) == u);
+        child_first += t.parent(u) == v;
+    }
+    EXPECT_GT(child_first, 400);
+    EXPECT_LT(child_first, 600);
+
+    std::ostringstream* ss = new std::ostringstream();
+    io::Writer w(*ss);
+    gen::broom(3, 2).write_edges(w);
+    EXPECT_EQ(ss->str(), "1 2\n2 3\n");
+}
+
+TEST(TreeGeneratorTest, Constructor_ShouldRejectNonTrees) {
+    EXPECT_NO_THROW(gen::Tree({-1, 0, 1, 1}));
+    EXPECT_THROW(gen::Tree({0, 1}), InvalidArgumentException);
+    EXPECT_THROW(gen::Tree({-1, -1}), InvalidArgumentException);
+    EXPECT_THROW(gen::Tree({-1, 2, 3, 1}), InvalidArgumentException);
+    EXPECT_THROW(gen::Tree({1, 2, 0, -1}), InvalidArgumentException);
+}